@@ -1,23 +1,31 @@
 #include "NRF24.h"
-#include "hardware/spi.h"
-#include "hardware/gpio.h"
 #include <string.h>
 #include <stdio.h>
-#include "pico/stdlib.h"
 
-// Constructor
+// Constructors
+#if NRF24_PICO
 NRF24::NRF24(spi_inst_t *spi, uint16_t sck, uint16_t mosi, uint16_t miso, uint16_t csn, uint16_t ce, uint16_t irq)
+    : pico_transport(spi, sck, mosi, miso, csn, ce, irq)
 {
-    this->spi = spi;
-    this->sck = sck;
-    this->mosi = mosi;
-    this->miso = miso;
-    this->csn = csn;
-    this->ce = ce;
-    this->irq = irq;
-    
+    init(&pico_transport);
+}
+#endif
+
+NRF24::NRF24(NRF24_Transport *transport)
+{
+    init(transport);
+}
+
+void NRF24::init(NRF24_Transport *transport)
+{
+    this->transport = transport;
+    transport->setTransferCallback(onTransferComplete, this);
+#if NRF24_TRACE
+    tracer.begin(transport);
+#endif
+
     // Initialize default values
-    this->status = 0;
+    this->status = NRF_STATUS_RX_P_NO; // RX FIFO empty
     this->fifo_status = 0;
     this->payload_size = 32;
     this->address_width = 5;
@@ -31,12 +39,66 @@ NRF24::NRF24(spi_inst_t *spi, uint16_t sck, uint16_t mosi, uint16_t miso, uint16
     this->auto_ack_enabled = true;
     this->is_plus_variant = false;
     this->rx_pipe_enabled = 0;
+    this->radio_state = NRF24_STATE_POWER_DOWN;
+    this->ce_high = false;
+    this->prim_rx = false;
+    this->power_up_us = 0;
+    this->power_up_pending = false;
+    
+    // Shadow cache is opt-in
+    memset(shadow_regs, 0, sizeof(shadow_regs));
+    this->shadow_enabled = false;
+    this->shadow_verify = false;
+    this->shadow_mismatches = 0;
+    
+    // No event callbacks until registered
+    this->rx_callback = NULL;
+    this->tx_callback = NULL;
+    this->max_rt_callback = NULL;
+    this->rx_callback_data = NULL;
+    this->tx_callback_data = NULL;
+    this->max_rt_callback_data = NULL;
+    this->callback_mask = 0;
+    this->irq_enabled = false;
+    this->spi_busy = false;
+    this->irq_deferred = false;
+    this->irq_servicing = false;
+    this->hop_deferred = false;
+    this->hop_channel = 0;
+    
+    // DMA is opt-in
+    this->dma_ce_pulse = false;
+    this->dma_clear_stale = false;
+    
+    // Streaming TX
+    this->stream_active = false;
+    this->stream_dropped = false;
+    this->stream_policy = NRF24_STREAM_REUSE;
+    this->stream_max_reuse = 3;
+    this->stream_reuse_count = 0;
+    this->stream_in_fifo = 0;
+    memset(&stream_report, 0, sizeof(stream_report));
+    memset(stream_failed_map, 0, sizeof(stream_failed_map));
+    
+    // Asynchronous TX
+    this->async_pending = false;
+    this->async_handle = 0;
+    this->async_start_us = 0;
+    this->async_timeout_us = 0;
+    memset(&async_result, 0, sizeof(async_result));
+    this->send_callback = NULL;
+    this->send_callback_data = NULL;
+    
+    // RX ring is attached by enableRxBuffer(), ACK queues by enableAckQueue()
+    memset(ack_staged, 0, sizeof(ack_staged));
+    this->ack_queue_pipes = 0;
+    this->ack_next_pipe = 0;
     
     // Initialize statistics
-    this->packets_lost = 0;
-    this->packets_sent = 0;
-    this->packets_received = 0;
-    this->retransmit_count = 0;
+    memset(&stats, 0, sizeof(stats));
+    this->tx_outstanding = false;
+    this->tx_latched = 0;
+    this->tx_start_us = 0;
     
     // Initialize pipe configurations
     for (int i = 0; i < NRF_MAX_PIPES; i++) {
@@ -54,37 +116,28 @@ NRF24::NRF24(spi_inst_t *spi, uint16_t sck, uint16_t mosi, uint16_t miso, uint16
 // Destructor
 NRF24::~NRF24()
 {
+    disableInterrupts();
     powerDown();
+    disableDMA();
+}
+
+// Platform access for layers built on top of the driver (timing, critical sections)
+NRF24_Transport *NRF24::getTransport()
+{
+    return transport;
 }
 
 // Initialize the NRF24L01 module
 bool NRF24::begin()
 {
-    // Initialize SPI
-    spi_init(this->spi, 4000000); // Start with 4MHz for initialization
-    gpio_set_function(sck, GPIO_FUNC_SPI);
-    gpio_set_function(miso, GPIO_FUNC_SPI);
-    gpio_set_function(mosi, GPIO_FUNC_SPI);
-    
-    // Initialize control pins
-    gpio_init(csn);
-    gpio_init(ce);
-    gpio_set_dir(csn, GPIO_OUT);
-    gpio_set_dir(ce, GPIO_OUT);
-    
-    // Initialize IRQ pin if specified
-    if (irq != 0xFF) {
-        gpio_init(irq);
-        gpio_set_dir(irq, GPIO_IN);
-        gpio_pull_up(irq);
+    // Bring up the bus and pins
+    if (!transport->begin()) {
+        return false;
     }
-    
-    // Set initial pin states
     ceLow();
-    csnHigh();
     
     // Wait for chip to stabilize
-    sleep_ms(5);
+    transport->delayUs(5000);
     
     // Check if chip is connected
     if (!isChipConnected()) {
@@ -95,11 +148,12 @@ bool NRF24::begin()
     reset();
     
     // Detect if this is a + variant
-    uint8_t setup = readReg(NRF_RF_SETUP_REGISTER);
-    writeReg(NRF_RF_SETUP_REGISTER, setup | 0x80);
-    if (readReg(NRF_RF_SETUP_REGISTER) & 0x80) {
+    uint8_t setup = readRegDirect(NRF_RF_SETUP_REGISTER);
+    uint8_t probe = setup | 0x80;
+    writeRegDirect(NRF_RF_SETUP_REGISTER, &probe, 1);
+    if (readRegDirect(NRF_RF_SETUP_REGISTER) & 0x80) {
         is_plus_variant = true;
-        writeReg(NRF_RF_SETUP_REGISTER, setup); // Restore original value
+        writeRegDirect(NRF_RF_SETUP_REGISTER, &setup, 1); // Restore original value
     }
     
     // Enable features for + variant
@@ -107,12 +161,185 @@ bool NRF24::begin()
         activateFeatures();
     }
     
+    // Pick up anything the probing above changed behind the cache
+    if (shadow_enabled) {
+        resyncShadow();
+    }
+    
     // Increase SPI speed after successful initialization
-    spi_set_baudrate(this->spi, 8000000); // 8MHz for normal operation
+    transport->setSpeed(8000000); // 8MHz for normal operation
     
     return true;
 }
 
+// Chip reset values, which begin(config) only writes where the config differs
+void NRF24::getDefaultConfig(NRF24_Config *config)
+{
+    memset(config, 0, sizeof(NRF24_Config));
+    config->channel = 2;
+    config->data_rate = NRF24_DATA_RATE_2MBPS;
+    config->power_level = NRF24_POWER_LEVEL_0DBM;
+    config->crc_length = NRF24_CRC_8BIT;
+    config->address_width = NRF24_ADDR_WIDTH_5BYTES;
+    config->retry_delay = NRF24_ARD_250US;
+    config->retry_count = 3;
+    config->payload_size = NRF_MAX_PAYLOAD_SIZE;
+    config->auto_ack_pipes = 0x3F;
+}
+
+bool NRF24::validateConfig(const NRF24_Config &config)
+{
+    if (config.channel > NRF_MAX_CHANNEL) return false;
+    if (config.data_rate > NRF24_DATA_RATE_250KBPS) return false;
+    if (config.power_level > NRF24_POWER_LEVEL_0DBM) return false;
+    if (config.crc_length > NRF24_CRC_16BIT) return false;
+    if (config.address_width < NRF24_ADDR_WIDTH_3BYTES || config.address_width > NRF24_ADDR_WIDTH_5BYTES) return false;
+    if (config.retry_delay > NRF24_ARD_4000US || config.retry_count > 15) return false;
+    if (config.payload_size == 0 || config.payload_size > NRF_MAX_PAYLOAD_SIZE) return false;
+    if (config.auto_ack_pipes > 0x3F) return false;
+    
+    // Auto-ack forces CRC on, and ACK payloads ride on dynamic payload lengths
+    if (config.auto_ack_pipes && config.crc_length == NRF24_CRC_DISABLED) return false;
+    if (config.ack_payloads && !config.dynamic_payloads) return false;
+    return true;
+}
+
+// Write a register only if the chip holds something else (a cold chip holds its reset value)
+void NRF24::applyRegister(uint8_t reg, uint8_t value)
+{
+    if (readRegDirect(reg) != value) {
+        writeRegDirect(reg, &value, 1);
+    }
+}
+
+void NRF24::applyAddress(uint8_t reg, const uint8_t *address, uint8_t width)
+{
+    uint8_t current[NRF_MAX_ADDR_SIZE];
+    uint8_t target[NRF_MAX_ADDR_SIZE];
+    memcpy(target, address, width);
+    transfer(NRF_R_REGISTER | reg, NULL, current, width);
+    if (memcmp(current, target, width) != 0) {
+        writeRegDirect(reg, target, width);
+    }
+}
+
+// Fast boot: only the remaining power-on reset time is waited out, registers that
+// already hold the wanted value are not written, and the oscillator startup after
+// PWR_UP overlaps with whatever the caller does until CE first has to rise
+bool NRF24::begin(const NRF24_Config &config)
+{
+    if (!validateConfig(config)) return false;
+    if (!transport->begin()) return false;
+    ceLow();
+    
+    uint32_t since_power_on = transport->micros() - config.power_on_us;
+    if (since_power_on < NRF24_POWER_ON_RESET_US) {
+        transport->delayUs(NRF24_POWER_ON_RESET_US - since_power_on);
+    }
+    if (!isChipConnected()) return false;
+    transport->setSpeed(8000000);
+    
+    // Register image
+    uint8_t width = config.address_width + 2;
+    uint8_t rf_setup = config.power_level << 1;
+    if (config.data_rate == NRF24_DATA_RATE_250KBPS) rf_setup |= NRF_RF_SETUP_RF_DR_LOW;
+    if (config.data_rate == NRF24_DATA_RATE_2MBPS) rf_setup |= NRF_RF_SETUP_RF_DR_HIGH;
+    uint8_t feature = 0;
+    if (config.dynamic_payloads) feature |= NRF_FEATURE_EN_DPL;
+    if (config.ack_payloads) feature |= NRF_FEATURE_EN_ACK_PAY;
+    if (config.dynamic_ack) feature |= NRF_FEATURE_EN_DYN_ACK;
+    uint8_t config_reg = NRF_CONFIG_PWR_UP;
+    if (config.crc_length != NRF24_CRC_DISABLED) config_reg |= NRF_CONFIG_EN_CRC;
+    if (config.crc_length == NRF24_CRC_16BIT) config_reg |= NRF_CONFIG_CRCO;
+    if (config.listen) config_reg |= NRF_CONFIG_PRIM_RX;
+    
+    applyRegister(NRF_SETUP_AW_REGISTER, config.address_width);
+    applyRegister(NRF_SETUP_RETR_REGISTER, (config.retry_delay << 4) | config.retry_count);
+    applyRegister(NRF_RF_CH_REGISTER, config.channel);
+    rf_setup |= readRegDirect(NRF_RF_SETUP_REGISTER) & 0x01;  // Obsolete LNA bit, reset value 1
+    applyRegister(NRF_RF_SETUP_REGISTER, rf_setup);
+    applyRegister(NRF_EN_AA_REGISTER, config.auto_ack_pipes);
+    applyRegister(NRF_EN_RXADDR_REGISTER, 0x03);
+    applyRegister(NRF_RX_PW_P0_REGISTER, config.payload_size);
+    applyRegister(NRF_RX_PW_P1_REGISTER, config.payload_size);
+    
+    // Original nRF24L01 parts ignore FEATURE until ACTIVATE
+    applyRegister(NRF_FEATURE_REGISTER, feature);
+    if (feature) {
+        is_plus_variant = readRegDirect(NRF_FEATURE_REGISTER) == feature;
+        if (!is_plus_variant) {
+            activateFeatures();
+            writeRegDirect(NRF_FEATURE_REGISTER, &feature, 1);
+        }
+    }
+    applyRegister(NRF_DYNPD_REGISTER, config.dynamic_payloads ? 0x3F : 0x00);
+    
+    if (config.tx_address) {
+        applyAddress(NRF_TX_ADDR_REGISTER, config.tx_address, width);
+        applyAddress(NRF_RX_ADDR_P0_REGISTER, config.tx_address, width);
+        memcpy(tx_address, config.tx_address, width);
+    }
+    if (config.rx_address) {
+        applyAddress(NRF_RX_ADDR_P1_REGISTER, config.rx_address, width);
+        memcpy(pipes[1].address, config.rx_address, width);
+    }
+    
+    // Leftovers from before an MCU-only reset
+    if (sendCommand(NRF_NOP) & (NRF_STATUS_RX_DR | NRF_STATUS_TX_DS | NRF_STATUS_MAX_RT)) {
+        clearInterrupts();
+    }
+    uint8_t fifo = readRegDirect(NRF_FIFO_STATUS_REGISTER);
+    if (!(fifo & NRF_FIFO_STATUS_TX_EMPTY)) flushTx();
+    if (!(fifo & NRF_FIFO_STATUS_RX_EMPTY)) flushRx();
+    
+    // Power up last; the startup time runs from here
+    bool was_powered = readRegDirect(NRF_CONFIG_REGISTER) & NRF_CONFIG_PWR_UP;
+    applyRegister(NRF_CONFIG_REGISTER, config_reg);
+    if (!was_powered) {
+        power_up_us = transport->micros();
+        power_up_pending = true;
+    }
+    
+    // Driver state
+    channel = config.channel;
+    data_rate = config.data_rate;
+    tx_power = config.power_level;
+    crc_length = config.crc_length;
+    address_width = width;
+    auto_retransmit_delay = config.retry_delay;
+    auto_retransmit_count = config.retry_count;
+    payload_size = config.payload_size;
+    messageLen = config.payload_size;
+    dynamic_payload_enabled = config.dynamic_payloads;
+    auto_ack_enabled = config.auto_ack_pipes != 0;
+    rx_pipe_enabled = 0x03;
+    for (uint8_t i = 0; i < NRF_MAX_PIPES; i++) {
+        pipes[i].address_width = width;
+        pipes[i].payload_size = config.payload_size;
+        pipes[i].auto_ack_enabled = config.auto_ack_pipes & (1 << i);
+        pipes[i].dynamic_payload_enabled = config.dynamic_payloads;
+    }
+    if (shadow_enabled) {
+        shadow_regs[NRF_CONFIG_REGISTER] = config_reg;
+        shadow_regs[NRF_EN_AA_REGISTER] = config.auto_ack_pipes;
+        shadow_regs[NRF_EN_RXADDR_REGISTER] = 0x03;
+        shadow_regs[NRF_SETUP_AW_REGISTER] = config.address_width;
+        shadow_regs[NRF_SETUP_RETR_REGISTER] = (config.retry_delay << 4) | config.retry_count;
+        shadow_regs[NRF_RF_CH_REGISTER] = config.channel;
+        shadow_regs[NRF_RF_SETUP_REGISTER] = rf_setup;
+        shadow_regs[NRF_DYNPD_REGISTER] = config.dynamic_payloads ? 0x3F : 0x00;
+        shadow_regs[NRF_FEATURE_REGISTER] = feature;
+    }
+    
+    prim_rx = config.listen;
+    radio_state = NRF24_STATE_STANDBY_I;
+    if (config.listen) {
+        ceHigh();
+        radio_state = NRF24_STATE_RX;
+    }
+    return true;
+}
+
 // Check if the chip is connected and responding
 bool NRF24::isConnected()
 {
@@ -124,7 +351,7 @@ void NRF24::reset()
 {
     // Power down
     powerDown();
-    sleep_ms(2);
+    transport->delayUs(2000);
     
     // Reset all registers to default values
     writeReg(NRF_CONFIG_REGISTER, 0x08);
@@ -171,6 +398,8 @@ void NRF24::reset()
     writeReg(NRF_DYNPD_REGISTER, 0x00);
     
     // Update internal state
+    radio_state = NRF24_STATE_POWER_DOWN;
+    prim_rx = false;
     payload_size = 32;
     address_width = 5;
     channel = 2;
@@ -182,13 +411,19 @@ void NRF24::reset()
 // Low-level register operations
 uint8_t NRF24::readReg(uint8_t reg)
 {
-    reg = NRF_R_REGISTER | (reg & 0x1F);
-    uint8_t result = 0;
-    csnLow();
-    spi_write_blocking(spi, &reg, 1);
-    spi_read_blocking(spi, 0x00, &result, 1);
-    csnHigh();
-    return result;
+    if (!shadow_enabled || !isShadowed(reg)) {
+        return readRegDirect(reg);
+    }
+    
+    if (shadow_verify) {
+        uint8_t actual = readRegDirect(reg);
+        if (actual != shadow_regs[reg]) {
+            // Counted, not printed: this also runs from the IRQ engine
+            shadow_regs[reg] = actual;
+            shadow_mismatches++;
+        }
+    }
+    return shadow_regs[reg];
 }
 
 void NRF24::writeReg(uint8_t reg, uint8_t data)
@@ -198,38 +433,145 @@ void NRF24::writeReg(uint8_t reg, uint8_t data)
 
 void NRF24::writeReg(uint8_t reg, uint8_t *data, uint8_t size)
 {
-    reg = NRF_W_REGISTER | (reg & 0x1F);
-    csnLow();
-    spi_write_blocking(spi, &reg, 1);
-    spi_write_blocking(spi, data, size);
-    csnHigh();
+    if (shadow_enabled && size == 1 && isShadowed(reg)) {
+        if (shadow_regs[reg] == data[0] && !shadow_verify) {
+            return; // Chip already holds this value
+        }
+        shadow_regs[reg] = data[0];
+    }
+    writeRegDirect(reg, data, size);
+}
+
+uint8_t NRF24::readRegDirect(uint8_t reg)
+{
+    uint8_t result = 0;
+    transfer(NRF_R_REGISTER | (reg & 0x1F), NULL, &result, 1);
+    return result;
+}
+
+void NRF24::writeRegDirect(uint8_t reg, uint8_t *data, uint8_t size)
+{
+    transfer(NRF_W_REGISTER | (reg & 0x1F), data, NULL, size);
+    
+    // The harvested byte predates this write, so apply the flags it just cleared
+    if ((reg & 0x1F) == NRF_STATUS_REGISTER) {
+        status &= ~(data[0] & (NRF_STATUS_RX_DR | NRF_STATUS_TX_DS | NRF_STATUS_MAX_RT));
+    }
+}
+
+bool NRF24::isShadowed(uint8_t reg)
+{
+    return reg <= NRF_FEATURE_REGISTER && (NRF_SHADOW_REGISTER_MASK & (1UL << reg)) != 0;
 }
 
 void NRF24::writeCommand(uint8_t cmd)
 {
-    csnLow();
-    spi_write_blocking(spi, &cmd, 1);
-    csnHigh();
+    transfer(cmd, NULL, NULL, 0);
 }
 
 uint8_t NRF24::sendCommand(uint8_t cmd)
 {
-    uint8_t status = 0;
-    csnLow();
-    spi_write_read_blocking(spi, &cmd, &status, 1);
-    csnHigh();
-    return status;
+    return transfer(cmd, NULL, NULL, 0);
+}
+
+// Single SPI transaction: command byte clocked full-duplex to capture STATUS, then
+// either len bytes written from tx or len bytes read into rx
+uint8_t NRF24::transfer(uint8_t cmd, uint8_t *tx, uint8_t *rx, uint8_t len)
+{
+    transport->waitTransfer();
+    spi_busy = true;
+    NRF24_TRACE_BEGIN(tracer);
+    status = transport->transfer(cmd, tx, rx, len);
+    NRF24_TRACE_END(tracer, cmd, len);
+    spi_busy = false;
+    
+    // A hop or IRQ that arrived mid-transaction was left for us to service
+    uint8_t result = status;
+    if (hop_deferred) {
+        hop_deferred = false;
+        setChannel(hop_channel);
+    }
+    if (irq_deferred) {
+        irq_deferred = false;
+        handleInterrupt();
+    }
+    return result;
+}
+
+// Payload transaction, handed to the transport's asynchronous path (DMA on the Pico)
+// when it takes it. Writes may return before the transfer completes; the next
+// transaction waits for it.
+void NRF24::payloadTransfer(uint8_t cmd, uint8_t *tx, uint8_t *rx, uint8_t len, bool wait)
+{
+    transport->waitTransfer();
+    spi_busy = true;
+    NRF24_TRACE_BEGIN(tracer);
+    if (!transport->startTransfer(cmd, tx, rx, len)) {
+        spi_busy = false;
+        transfer(cmd, tx, rx, len);
+        return;
+    }
+    NRF24_TRACE_END(tracer, cmd, len | NRF24_TRACE_ASYNC);
+    
+    if (wait || rx) {
+        transport->waitTransfer();
+    }
+}
+
+void NRF24::onTransferComplete(void *context, uint8_t status)
+{
+    static_cast<NRF24 *>(context)->transferComplete(status);
+}
+
+// Asynchronous transfer done: the transport has already released CSN
+void NRF24::transferComplete(uint8_t status)
+{
+    this->status = status;
+    spi_busy = false;
+    
+    // Deferred startWrite() work: drop stale flags, then begin the CE pulse
+    if (dma_clear_stale) {
+        dma_clear_stale = false;
+        if (status & (NRF_STATUS_RX_DR | NRF_STATUS_TX_DS | NRF_STATUS_MAX_RT)) {
+            if (tx_outstanding) {
+                txComplete(status, readReg(NRF_OBSERVE_TX_REGISTER), false);
+            }
+            clearInterrupts();
+        }
+    }
+    if (dma_ce_pulse) {
+        dma_ce_pulse = false;
+        tx_outstanding = true;
+        tx_start_us = transport->micros();
+        ceHigh();
+    }
+    
+    if (hop_deferred) {
+        hop_deferred = false;
+        setChannel(hop_channel);
+    }
+    if (irq_deferred) {
+        irq_deferred = false;
+        handleInterrupt();
+    }
 }
 
 // Internal utility functions
 void NRF24::flushTx()
 {
     writeCommand(NRF_FLUSH_TX);
+    status &= ~NRF_STATUS_TX_FULL;
+    
+    // Staged ACK payloads are gone from the chip but still queued; stage them again
+    if (ack_queue_pipes) {
+        memset(ack_staged, 0, sizeof(ack_staged));
+    }
 }
 
 void NRF24::flushRx()
 {
     writeCommand(NRF_FLUSH_RX);
+    status |= NRF_STATUS_RX_P_NO; // RX FIFO empty
 }
 
 void NRF24::clearInterrupts()
@@ -239,38 +581,65 @@ void NRF24::clearInterrupts()
 
 void NRF24::updateStatus()
 {
-    status = readReg(NRF_STATUS_REGISTER);
+    // STATUS is harvested by the same transaction
     fifo_status = readReg(NRF_FIFO_STATUS_REGISTER);
 }
 
 void NRF24::powerUp()
 {
+    // Only the power down -> standby transition needs the oscillator startup delay
+    if (radio_state != NRF24_STATE_POWER_DOWN) return;
+    
     uint8_t config = readReg(NRF_CONFIG_REGISTER);
     config |= NRF_CONFIG_PWR_UP;
     writeReg(NRF_CONFIG_REGISTER, config);
-    sleep_us(1500); // Wait for power up
+    power_up_us = transport->micros();
+    power_up_pending = true;
+    radio_state = NRF24_STATE_STANDBY_I;
+}
+
+// Start a transmission. A transport that can time the pulse itself (PIO) queues
+// it and returns at once; otherwise hold CE high for the minimum width here.
+void NRF24::cePulse()
+{
+    if (power_up_pending) waitPowerUp();
+    if (transport->pulseCE(NRF24_CE_PULSE_US)) {
+        ce_high = false;  // The pulse ends low whatever the level before it
+        return;
+    }
+    transport->setCE(true);
+    transport->delayUs(NRF24_CE_PULSE_US);
+    ceLow();
+}
+
+// Standby is only reached NRF24_POWER_UP_US after PWR_UP; wait out what is left
+void NRF24::waitPowerUp()
+{
+    uint32_t elapsed = transport->micros() - power_up_us;
+    if (elapsed < NRF24_POWER_UP_US) {
+        transport->delayUs(NRF24_POWER_UP_US - elapsed);
+    }
+    power_up_pending = false;
 }
 
 void NRF24::powerDown()
 {
+    ceLow();
     uint8_t config = readReg(NRF_CONFIG_REGISTER);
     config &= ~NRF_CONFIG_PWR_UP;
     writeReg(NRF_CONFIG_REGISTER, config);
+    radio_state = NRF24_STATE_POWER_DOWN;
 }
 
 void NRF24::activateFeatures()
 {
-    uint8_t activate_cmd = 0x50;
     uint8_t activate_data = 0x73;
-    csnLow();
-    spi_write_blocking(spi, &activate_cmd, 1);
-    spi_write_blocking(spi, &activate_data, 1);
-    csnHigh();
+    transfer(0x50, &activate_data, NULL, 1);
 }
 
 bool NRF24::isChipConnected()
 {
-    uint8_t setup_aw = readReg(NRF_SETUP_AW_REGISTER);
+    uint8_t setup_aw = readRegDirect(NRF_SETUP_AW_REGISTER);
     return (setup_aw & 0x0C) == 0x00 && (setup_aw & 0x03) != 0x00;
 }
 
@@ -303,41 +672,65 @@ void NRF24::setPowerUp(bool power_up)
 
 bool NRF24::isPoweredUp()
 {
-    return getRegisterBit(NRF_CONFIG_REGISTER, 1);
+    return radio_state != NRF24_STATE_POWER_DOWN;
 }
 
 // Mode switching
 void NRF24::setModeRX()
 {
+    if (radio_state == NRF24_STATE_RX) return;
+    
     ceLow();
-    setRegisterBit(NRF_CONFIG_REGISTER, 0, true); // Set PRIM_RX
+    if (!prim_rx) {
+        setRegisterBit(NRF_CONFIG_REGISTER, 0, true); // Set PRIM_RX
+        prim_rx = true;
+    }
     powerUp();
     ceHigh();
-    sleep_us(130); // RX settling time
+    transport->delayUs(130); // RX settling time
+    radio_state = NRF24_STATE_RX;
 }
 
 void NRF24::setModeTX()
 {
+    // Already a powered-up PTX: the next CE pulse transmits straight away
+    if (!prim_rx && radio_state != NRF24_STATE_POWER_DOWN) return;
+    
+    bool was_rx = (radio_state == NRF24_STATE_RX);
     ceLow();
-    setRegisterBit(NRF_CONFIG_REGISTER, 0, false); // Clear PRIM_RX
+    if (prim_rx) {
+        setRegisterBit(NRF_CONFIG_REGISTER, 0, false); // Clear PRIM_RX
+        prim_rx = false;
+    }
     powerUp();
-    sleep_us(130); // TX settling time
+    radio_state = NRF24_STATE_STANDBY_I;
+    if (was_rx) {
+        transport->delayUs(130); // RX to TX turnaround
+    }
 }
 
 void NRF24::setModeStandby()
 {
     ceLow();
-    powerUp();
+    if (radio_state == NRF24_STATE_POWER_DOWN) {
+        powerUp();
+    }
+    radio_state = NRF24_STATE_STANDBY_I;
 }
 
 bool NRF24::isModeTX()
 {
-    return !getRegisterBit(NRF_CONFIG_REGISTER, 0);
+    return !prim_rx;
 }
 
 bool NRF24::isModeRX()
 {
-    return getRegisterBit(NRF_CONFIG_REGISTER, 0);
+    return prim_rx;
+}
+
+NRF24_RadioState NRF24::getRadioState()
+{
+    return radio_state;
 }
 
 // Channel and frequency configuration
@@ -350,6 +743,18 @@ void NRF24::setChannel(uint8_t channel)
     writeReg(NRF_RF_CH_REGISTER, channel);
 }
 
+// Channel change from a hop timer: if it interrupted a transaction, the write is
+// left to the end of that transaction
+void NRF24::hopToChannel(uint8_t channel)
+{
+    if (spi_busy) {
+        hop_channel = channel;
+        hop_deferred = true;
+        return;
+    }
+    setChannel(channel);
+}
+
 uint8_t NRF24::getChannel()
 {
     return readReg(NRF_RF_CH_REGISTER);
@@ -509,6 +914,11 @@ void NRF24::openReadingPipe(uint8_t pipe, uint8_t *address)
     pipes[pipe].address_width = address_width;
     pipes[pipe].payload_size = payload_size;
     rx_pipe_enabled |= (1 << pipe);
+    
+    // A pipe opened after enableAckPayload() needs DPL to carry ACK payloads too
+    if (readReg(NRF_FEATURE_REGISTER) & NRF_FEATURE_EN_ACK_PAY) {
+        enableDynamicPayload(pipe);
+    }
 }
 
 void NRF24::openWritingPipe(uint8_t *address)
@@ -570,6 +980,9 @@ void NRF24::setAutoAck(bool enable)
         writeReg(NRF_EN_AA_REGISTER, 0x00); // Disable for all pipes
     }
     this->auto_ack_enabled = enable;
+    for (uint8_t i = 0; i < NRF_MAX_PIPES; i++) {
+        pipes[i].auto_ack_enabled = enable;
+    }
 }
 
 void NRF24::setAutoAck(uint8_t pipe, bool enable)
@@ -681,10 +1094,18 @@ bool NRF24::isDynamicPayloadEnabled(uint8_t pipe)
 }
 
 // Payload with ACK
+// ACK payloads need dynamic payloads on both ends of a pipe: pipe 0 for the ACKs a
+// PTX receives, and every open reading pipe for the ones a PRX sends
 void NRF24::enableAckPayload()
 {
     writeReg(NRF_FEATURE_REGISTER, readReg(NRF_FEATURE_REGISTER) | NRF_FEATURE_EN_ACK_PAY | NRF_FEATURE_EN_DPL);
-    writeReg(NRF_DYNPD_REGISTER, readReg(NRF_DYNPD_REGISTER) | 0x01); // Enable for pipe 0
+    uint8_t dynpd = 0x01 | rx_pipe_enabled;
+    writeReg(NRF_DYNPD_REGISTER, readReg(NRF_DYNPD_REGISTER) | dynpd);
+    for (uint8_t i = 0; i < NRF_MAX_PIPES; i++) {
+        if (dynpd & (1 << i)) {
+            pipes[i].dynamic_payload_enabled = true;
+        }
+    }
 }
 
 void NRF24::disableAckPayload()
@@ -696,11 +1117,18 @@ void NRF24::writeAckPayload(uint8_t pipe, uint8_t *data, uint8_t len)
 {
     if (pipe >= NRF_MAX_PIPES || len > NRF_MAX_PAYLOAD_SIZE) return;
     
-    uint8_t cmd = NRF_W_ACK_PAYLOAD | pipe;
-    csnLow();
-    spi_write_blocking(spi, &cmd, 1);
-    spi_write_blocking(spi, data, len);
-    csnHigh();
+    payloadTransfer(NRF_W_ACK_PAYLOAD | pipe, data, NULL, len, false);
+}
+
+// W_TX_PAYLOAD_NO_ACK is only honoured with EN_DYN_ACK set
+void NRF24::enableDynamicAck()
+{
+    writeReg(NRF_FEATURE_REGISTER, readReg(NRF_FEATURE_REGISTER) | NRF_FEATURE_EN_DYN_ACK);
+}
+
+void NRF24::disableDynamicAck()
+{
+    writeReg(NRF_FEATURE_REGISTER, readReg(NRF_FEATURE_REGISTER) & ~NRF_FEATURE_EN_DYN_ACK);
 }
 
 // Data transmission
@@ -716,44 +1144,48 @@ bool NRF24::write(uint8_t *data, uint8_t len, bool multicast)
     // Switch to TX mode
     setModeTX();
     
-    // Clear previous interrupts
-    clearInterrupts();
-    
-    // Write payload
+    // Write payload; the STATUS harvested here tells us whether stale flags need clearing
     uint8_t cmd = multicast ? NRF_W_TX_PAYLOAD_NO_ACK : NRF_W_TX_PAYLOAD;
-    csnLow();
-    spi_write_blocking(spi, &cmd, 1);
-    spi_write_blocking(spi, data, len);
-    csnHigh();
+    payloadTransfer(cmd, data, NULL, len, true);
+    if (status & (NRF_STATUS_RX_DR | NRF_STATUS_TX_DS | NRF_STATUS_MAX_RT)) {
+        if (tx_outstanding) {
+            txComplete(status, readReg(NRF_OBSERVE_TX_REGISTER), false);
+        }
+        clearInterrupts();
+    }
     
     // Start transmission
-    ceHigh();
-    sleep_us(15); // Minimum pulse width
-    ceLow();
-    
-    // Wait for transmission to complete
-    uint32_t timeout = 0;
-    while (!(readReg(NRF_STATUS_REGISTER) & (NRF_STATUS_TX_DS | NRF_STATUS_MAX_RT))) {
-        sleep_us(1);
-        if (++timeout > 10000) { // 10ms timeout
+    uint32_t deadline_us = getTxDeadlineUs(len, multicast);
+    uint32_t start = transport->micros();
+    tx_latched = 0;
+    cePulse();
+    radio_state = NRF24_STATE_TX;
+    
+    // Wait for transmission to complete, no longer than the configuration allows.
+    // Polling OBSERVE_TX instead of NOP picks up ARC in the same transaction.
+    // With interrupts on, the IRQ engine may have cleared the flags first.
+    uint8_t observe_tx;
+    uint8_t flags;
+    while (true) {
+        observe_tx = readReg(NRF_OBSERVE_TX_REGISTER);
+        flags = (status | tx_latched) & (NRF_STATUS_TX_DS | NRF_STATUS_MAX_RT);
+        if (flags) break;
+        transport->delayUs(1);
+        if (transport->micros() - start > deadline_us) {
             flushTx();
+            radio_state = NRF24_STATE_STANDBY_I;
+            recordTx(false, observe_tx, transport->micros() - start);
             return false;
         }
     }
+    radio_state = NRF24_STATE_STANDBY_I;
     
-    uint8_t status = readReg(NRF_STATUS_REGISTER);
-    bool result = (status & NRF_STATUS_TX_DS) != 0;
+    bool result = (flags & NRF_STATUS_TX_DS) != 0;
     
     // Clear interrupts
     clearInterrupts();
     
-    // Update statistics
-    if (result) {
-        packets_sent++;
-    } else {
-        packets_lost++;
-    }
-    
+    recordTx(result, observe_tx, transport->micros() - start);
     return result;
 }
 
@@ -769,52 +1201,384 @@ void NRF24::startWrite(uint8_t *data, uint8_t len, bool multicast)
     // Switch to TX mode
     setModeTX();
     
-    // Clear previous interrupts
-    clearInterrupts();
-    
-    // Write payload
+    // Write payload, then clear any stale flags it reported
     uint8_t cmd = multicast ? NRF_W_TX_PAYLOAD_NO_ACK : NRF_W_TX_PAYLOAD;
-    csnLow();
-    spi_write_blocking(spi, &cmd, 1);
-    spi_write_blocking(spi, data, len);
-    csnHigh();
+    transport->waitTransfer();
+    tx_latched = 0;
+    if (power_up_pending) waitPowerUp();  // The completion handler raises CE from the ISR
+    dma_clear_stale = true;
+    dma_ce_pulse = true;
+    spi_busy = true;
+    NRF24_TRACE_BEGIN(tracer);
+    if (transport->startTransfer(cmd, data, NULL, len)) {
+        NRF24_TRACE_END(tracer, cmd, len | NRF24_TRACE_ASYNC);
+        
+        // The completion handler finishes the job and raises CE, which stays
+        // high (standby-II once the FIFO drains) until the next mode change
+        radio_state = NRF24_STATE_TX;
+        return;
+    }
+    dma_clear_stale = false;
+    dma_ce_pulse = false;
+    spi_busy = false;
+    transfer(cmd, data, NULL, len);
+    if (status & (NRF_STATUS_RX_DR | NRF_STATUS_TX_DS | NRF_STATUS_MAX_RT)) {
+        if (tx_outstanding) {
+            txComplete(status, readReg(NRF_OBSERVE_TX_REGISTER), false);
+        }
+        clearInterrupts();
+    }
     
     // Start transmission
-    ceHigh();
-    sleep_us(15); // Minimum pulse width
-    ceLow();
+    tx_outstanding = true;
+    tx_start_us = transport->micros();
+    cePulse();
+    radio_state = NRF24_STATE_TX;
 }
 
 bool NRF24::writeBlocking(uint8_t *data, uint8_t len, uint32_t timeout_ms)
 {
     startWrite(data, len);
     
-    uint32_t start_time = to_ms_since_boot(get_absolute_time());
-    uint32_t current_time = start_time;
+    uint32_t start_time = transport->micros();
     
-    while (current_time - start_time < timeout_ms) {
-        uint8_t status = readReg(NRF_STATUS_REGISTER);
-        if (status & (NRF_STATUS_TX_DS | NRF_STATUS_MAX_RT)) {
-            bool result = (status & NRF_STATUS_TX_DS) != 0;
+    uint8_t observe_tx = 0;
+    while ((transport->micros() - start_time) / 1000 < timeout_ms) {
+        observe_tx = readReg(NRF_OBSERVE_TX_REGISTER);
+        uint8_t flags = (status | tx_latched) & (NRF_STATUS_TX_DS | NRF_STATUS_MAX_RT);
+        if (flags) {
             clearInterrupts();
-            
-            if (result) {
-                packets_sent++;
-            } else {
-                packets_lost++;
-            }
-            
-            return result;
+            radio_state = txIdleState();
+            txComplete(flags, observe_tx, true);
+            return (flags & NRF_STATUS_TX_DS) != 0;
         }
-        sleep_us(10);
-        current_time = to_ms_since_boot(get_absolute_time());
+        transport->delayUs(10);
     }
     
     // Timeout occurred
     flushTx();
+    radio_state = txIdleState();
+    txComplete(NRF_STATUS_MAX_RT, observe_tx, true);
+    return false;
+}
+
+// Asynchronous transmission. The payload goes out as with startWrite(); the outcome
+// arrives through poll() or, with interrupts enabled, from the IRQ engine.
+uint16_t NRF24::sendAsync(uint8_t *data, uint8_t len, bool multicast, uint32_t timeout_us)
+{
+    if (len > NRF_MAX_PAYLOAD_SIZE || async_pending || stream_active) return 0;
+    
+    async_handle++;
+    if (async_handle == 0) async_handle = 1;
+    async_start_us = transport->micros();
+    async_timeout_us = timeout_us ? timeout_us : getTxDeadlineUs(len, multicast);
+    async_pending = true;
+    
+    startWrite(data, len, multicast);
+    return async_handle;
+}
+
+// One SPI transaction per call: the OBSERVE_TX read brings STATUS with it. The call
+// that sees the send finish also clears the flags (and flushes the TX FIFO on failure).
+NRF24_TxOutcome NRF24::poll()
+{
+    if (!async_pending) {
+        return async_result.handle ? async_result.outcome : NRF24_TX_UNKNOWN;
+    }
+    
+    bool timed_out = transport->micros() - async_start_us > async_timeout_us;
+    
+    // The IRQ engine owns the flags; only the deadline is checked here
+    if (irq_enabled) {
+        if (timed_out) {
+            finishSend(NRF24_TX_TIMEOUT, readReg(NRF_OBSERVE_TX_REGISTER));
+        }
+        return async_pending ? NRF24_TX_PENDING : async_result.outcome;
+    }
+    
+    uint8_t observe_tx = readReg(NRF_OBSERVE_TX_REGISTER);
+    uint8_t flags = status & (NRF_STATUS_TX_DS | NRF_STATUS_MAX_RT);
+    if (flags) {
+        writeReg(NRF_STATUS_REGISTER, flags);
+        finishSend((flags & NRF_STATUS_TX_DS) ? NRF24_TX_ACKED : NRF24_TX_FAILED, observe_tx);
+    } else if (timed_out) {
+        finishSend(NRF24_TX_TIMEOUT, observe_tx);
+    }
+    return async_pending ? NRF24_TX_PENDING : async_result.outcome;
+}
+
+// Record the outcome of the packet in flight and report it. STATUS is already cleared.
+void NRF24::finishSend(NRF24_TxOutcome outcome, uint8_t observe_tx)
+{
+    // Claim the send before any SPI: an IRQ deferred by flushTx() below would
+    // otherwise finish it a second time from serviceEvents()
+    uint32_t irq_state = transport->enterCritical();
+    if (!async_pending) {
+        transport->exitCritical(irq_state);
+        return;
+    }
+    async_result.handle = async_handle;
+    async_result.outcome = outcome;
+    async_result.retransmits = observe_tx & 0x0F;
+    async_result.elapsed_us = transport->micros() - async_start_us;
+    async_pending = false;
+    txComplete((outcome == NRF24_TX_ACKED) ? NRF_STATUS_TX_DS : NRF_STATUS_MAX_RT, observe_tx, true);
+    transport->exitCritical(irq_state);
+    
+    // MAX_RT leaves the payload at the head of the TX FIFO
+    if (outcome != NRF24_TX_ACKED) {
+        flushTx();
+    }
+    radio_state = txIdleState();
+    
+    if (send_callback) {
+        send_callback(this, &async_result, send_callback_data);
+    }
+}
+
+NRF24_TxOutcome NRF24::getSendOutcome(uint16_t handle, NRF24_SendResult *result)
+{
+    if (async_pending && handle == async_handle) return NRF24_TX_PENDING;
+    if (handle == 0 || handle != async_result.handle) return NRF24_TX_UNKNOWN;
+    if (result) {
+        *result = async_result;
+    }
+    return async_result.outcome;
+}
+
+bool NRF24::isSendPending()
+{
+    return async_pending;
+}
+
+// With interrupts enabled the callback runs in the IRQ handler
+void NRF24::onSendComplete(NRF24_SendCallback callback, void *user_data)
+{
+    send_callback = callback;
+    send_callback_data = user_data;
+    if (callback) {
+        unmaskInterrupt(NRF_CONFIG_MASK_TX_DS | NRF_CONFIG_MASK_MAX_RT);
+    }
+}
+
+// Time on air of one packet, rounded up to whole microseconds
+uint32_t NRF24::airtimeUs(NRF24_DataRate rate, uint8_t address_width, uint8_t payload_len, NRF24_CRCLength crc)
+{
+    uint32_t bits = (NRF24_PREAMBLE_BYTES + address_width + payload_len + crc) * 8 + NRF24_PCF_BITS;
+    switch (rate) {
+        case NRF24_DATA_RATE_2MBPS:
+            return (bits + 1) / 2;
+        case NRF24_DATA_RATE_250KBPS:
+            return bits * 4;
+        default:
+            return bits;
+    }
+}
+
+uint32_t NRF24::getAirtimeUs(uint8_t payload_len)
+{
+    return airtimeUs((NRF24_DataRate)data_rate, address_width, payload_len, (NRF24_CRCLength)crc_length);
+}
+
+// With dynamic payloads the ACK may carry a full ACK payload, so assume the worst
+uint32_t NRF24::getAckAirtimeUs()
+{
+    return getAirtimeUs(dynamic_payload_enabled ? NRF_MAX_PAYLOAD_SIZE : 0);
+}
+
+// Every attempt is TX settling plus the packet, followed by the ACK wait: ARD, or the
+// turnaround plus the ACK itself if that is longer. The last attempt ends in TX_DS or MAX_RT.
+uint32_t NRF24::getTxDeadlineUs(uint8_t payload_len, bool multicast)
+{
+    uint32_t attempt_us = NRF24_TX_SETTLE_US + getAirtimeUs(payload_len);
+    if (multicast || !pipes[0].auto_ack_enabled) {
+        return attempt_us + NRF24_TX_DEADLINE_MARGIN_US;
+    }
+    
+    uint32_t ard_us = (auto_retransmit_delay + 1) * 250;
+    uint32_t ack_us = NRF24_TX_SETTLE_US + getAckAirtimeUs();
+    attempt_us += (ard_us > ack_us) ? ard_us : ack_us;
+    return (auto_retransmit_count + 1) * attempt_us + NRF24_TX_DEADLINE_MARGIN_US;
+}
+
+// Streaming transmission
+void NRF24::setStreamPolicy(NRF24_StreamPolicy policy, uint8_t max_reuse)
+{
+    this->stream_policy = policy;
+    this->stream_max_reuse = max_reuse;
+}
+
+// Queue one payload with CE held high. Blocks only while the TX FIFO is full;
+// MAX_RT on the head packet is handled according to the stream policy. Returns false
+// without queuing if the FIFO stays full, or if packets were dropped since the last
+// call (see getStreamReport()).
+//
+// With interrupts on, the IRQ engine may clear TX_DS / MAX_RT between our
+// transactions and hands them to streamPoll() itself, so our own polls and the
+// FIFO bookkeeping run with it held off.
+bool NRF24::writeFast(uint8_t *data, uint8_t len, bool multicast)
+{
+    if (len > NRF_MAX_PAYLOAD_SIZE) return false;
+    
+    if (!stream_active) {
+        setModeTX();
+        memset(&stream_report, 0, sizeof(stream_report));
+        stream_reuse_count = 0;
+        stream_in_fifo = 0;
+        stream_dropped = false;
+        stream_active = true;
+    }
+    
+    // stream_in_fifo never undercounts, so below the depth there is room without asking
+    uint32_t start = transport->micros();
+    while (stream_in_fifo >= NRF_TX_FIFO_DEPTH || (status & NRF_STATUS_MAX_RT)) {
+        uint32_t irq_state = transport->enterCritical();
+        streamPoll(sendCommand(NRF_NOP));
+        if (status & NRF_STATUS_TX_FULL) {
+            stream_in_fifo = NRF_TX_FIFO_DEPTH;
+        } else if (stream_in_fifo >= NRF_TX_FIFO_DEPTH) {
+            stream_in_fifo = NRF_TX_FIFO_DEPTH - 1;
+        }
+        bool room = stream_in_fifo < NRF_TX_FIFO_DEPTH && !(status & NRF_STATUS_MAX_RT);
+        transport->exitCritical(irq_state);
+        if (room) break;
+        if (transport->micros() - start > NRF24_STREAM_TIMEOUT_MS * 1000) return false;
+    }
+    
+    // Dropped here or by the IRQ engine: the caller decides whether to go on
+    if (stream_dropped) {
+        stream_dropped = false;
+        return false;
+    }
+    
+    uint32_t irq_state = transport->enterCritical();
+    uint32_t seq = stream_report.queued;
+    stream_failed_map[(seq % NRF24_STREAM_LOG_SIZE) / 8] &= ~(1 << (seq % 8));
+    
+    uint8_t cmd = multicast ? NRF_W_TX_PAYLOAD_NO_ACK : NRF_W_TX_PAYLOAD;
+    payloadTransfer(cmd, data, NULL, len, false);
+    stream_report.queued++;
+    stream_in_fifo++;
+    transport->exitCritical(irq_state);
+    
+    ceHigh();
+    radio_state = NRF24_STATE_TX;
+    return true;
+}
+
+// Handle TX_DS / MAX_RT from a polled STATUS. Returns false if packets were dropped.
+bool NRF24::streamPoll(uint8_t flags)
+{
+    if (flags & NRF_STATUS_TX_DS) {
+        writeReg(NRF_STATUS_REGISTER, NRF_STATUS_TX_DS);
+        if (stream_in_fifo > 0) stream_in_fifo--;
+        if (stream_in_fifo == 0) radio_state = NRF24_STATE_STANDBY_II;  // Drained with CE high
+        stream_reuse_count = 0;
+    }
+    
+    if (!(flags & NRF_STATUS_MAX_RT)) return true;
+    
+    stream_report.max_rt_events++;
+    if (stream_policy == NRF24_STREAM_REUSE && stream_reuse_count < stream_max_reuse) {
+        // The failed payload is still at the head of the FIFO; a fresh CE edge resends it
+        stream_reuse_count++;
+        stream_report.reuses++;
+        writeReg(NRF_STATUS_REGISTER, NRF_STATUS_MAX_RT);
+        ceLow();
+        ceHigh();
+        return true;
+    }
+    
+    streamDrop();
+    writeReg(NRF_STATUS_REGISTER, NRF_STATUS_MAX_RT);
     return false;
 }
 
+// Flush the TX FIFO and record everything still in it as failed
+void NRF24::streamDrop()
+{
+    // Tighten the in-FIFO bound with FIFO_STATUS before attributing failures
+    uint8_t fifo = readReg(NRF_FIFO_STATUS_REGISTER);
+    if (fifo & NRF_FIFO_STATUS_TX_EMPTY) {
+        stream_in_fifo = 0;
+    } else if (fifo & NRF_FIFO_STATUS_TX_FULL) {
+        stream_in_fifo = NRF_TX_FIFO_DEPTH;
+    } else if (stream_in_fifo == 0 || stream_in_fifo >= NRF_TX_FIFO_DEPTH) {
+        stream_in_fifo = (stream_in_fifo == 0) ? 1 : NRF_TX_FIFO_DEPTH - 1;
+    }
+    
+    for (uint32_t seq = stream_report.queued - stream_in_fifo; seq < stream_report.queued; seq++) {
+        stream_failed_map[(seq % NRF24_STREAM_LOG_SIZE) / 8] |= (1 << (seq % 8));
+    }
+    stream_report.dropped += stream_in_fifo;
+    stream_dropped = true;
+    stream_in_fifo = 0;
+    stream_reuse_count = 0;
+    flushTx();
+    radio_state = txIdleState();
+}
+
+// Wait for the TX FIFO to drain, then leave CE low. Returns true if nothing was dropped.
+bool NRF24::txStandBy(uint32_t timeout_ms)
+{
+    if (!stream_active) return true;
+    
+    uint32_t start_time = transport->micros();
+    while (true) {
+        uint32_t irq_state = transport->enterCritical();
+        bool empty = (readReg(NRF_FIFO_STATUS_REGISTER) & NRF_FIFO_STATUS_TX_EMPTY) != 0;
+        if (empty) {
+            stream_in_fifo = 0;
+        } else {
+            streamPoll(status);
+        }
+        transport->exitCritical(irq_state);
+        if (empty) break;
+        if ((transport->micros() - start_time) / 1000 >= timeout_ms) {
+            irq_state = transport->enterCritical();
+            streamDrop();
+            transport->exitCritical(irq_state);
+            break;
+        }
+    }
+    
+    // Catch a final TX_DS / MAX_RT pair so no stale flag leaks into later writes
+    if (status & (NRF_STATUS_TX_DS | NRF_STATUS_MAX_RT)) {
+        writeReg(NRF_STATUS_REGISTER, NRF_STATUS_TX_DS | NRF_STATUS_MAX_RT);
+    }
+    
+    ceLow();
+    radio_state = NRF24_STATE_STANDBY_I;
+    stream_active = false;
+    
+    stream_report.acked = stream_report.queued - stream_report.dropped;
+    stats.tx_packets += stream_report.acked;
+    stats.tx_failed += stream_report.dropped;
+    return stream_report.dropped == 0;
+}
+
+void NRF24::getStreamReport(NRF24_StreamReport *report)
+{
+    *report = stream_report;
+    if (stream_active) {
+        report->acked = stream_report.queued - stream_in_fifo - stream_report.dropped;
+    }
+}
+
+NRF24_TxOutcome NRF24::getStreamOutcome(uint32_t seq)
+{
+    if (seq >= stream_report.queued || stream_report.queued - seq > NRF24_STREAM_LOG_SIZE) {
+        return NRF24_TX_UNKNOWN;
+    }
+    if (stream_failed_map[(seq % NRF24_STREAM_LOG_SIZE) / 8] & (1 << (seq % 8))) {
+        return NRF24_TX_FAILED;
+    }
+    if (stream_active && seq >= stream_report.queued - stream_in_fifo) {
+        return NRF24_TX_PENDING;
+    }
+    return NRF24_TX_ACKED;
+}
+
 // Data reception
 bool NRF24::available()
 {
@@ -824,10 +1588,15 @@ bool NRF24::available()
 
 bool NRF24::available(uint8_t *pipe_num)
 {
-    uint8_t status = readReg(NRF_STATUS_REGISTER);
+    // Only we can drain the RX FIFO, so a harvested STATUS showing a pipe is still valid;
+    // otherwise a single NOP refreshes it
+    if ((status & NRF_STATUS_RX_P_NO) == NRF_STATUS_RX_P_NO) {
+        sendCommand(NRF_NOP);
+    }
     
-    if (status & NRF_STATUS_RX_DR) {
-        *pipe_num = (status & NRF_STATUS_RX_P_NO) >> 1;
+    uint8_t pipe = (status & NRF_STATUS_RX_P_NO) >> 1;
+    if (pipe < NRF_MAX_PIPES) {
+        *pipe_num = pipe;
         return true;
     }
     
@@ -842,28 +1611,250 @@ uint8_t NRF24::read(uint8_t *data, uint8_t len)
         payload_len = getDynamicPayloadSize();
         if (payload_len > len) payload_len = len;
     }
+    uint8_t pipe = (status & NRF_STATUS_RX_P_NO) >> 1;
     
-    csnLow();
-    uint8_t cmd = NRF_R_RX_PAYLOAD;
-    spi_write_blocking(spi, &cmd, 1);
-    spi_read_blocking(spi, 0x00, data, payload_len);
-    csnHigh();
+    payloadTransfer(NRF_R_RX_PAYLOAD, NULL, data, payload_len, true);
     
-    // Clear RX interrupt
+    // Clear RX interrupt; the STATUS this harvests shows whether more payloads are queued
     writeReg(NRF_STATUS_REGISTER, NRF_STATUS_RX_DR);
     
-    packets_received++;
+    recordRx(pipe, payload_len);
     return payload_len;
 }
 
+// Drain the RX FIFO in one pass: two transactions per payload (width or NOP, then the
+// payload), and RX_DR is only cleared once the FIFO is empty
+uint8_t NRF24::readBurst(NRF24_Packet *packets, uint8_t max)
+{
+    bool any_dynamic = anyDynamicPayloads();
+    uint8_t count = 0;
+    
+    while (count < max) {
+        uint8_t pipe, len;
+        if (!peekRxFifo(any_dynamic, &pipe, &len)) {
+            if (!(status & NRF_STATUS_RX_DR)) break;
+            
+            // The STATUS harvested by the clear shows a payload that arrived meanwhile
+            writeReg(NRF_STATUS_REGISTER, NRF_STATUS_RX_DR);
+            if (((status & NRF_STATUS_RX_P_NO) >> 1) >= NRF_MAX_PIPES) break;
+            continue;
+        }
+        
+        NRF24_Packet *packet = &packets[count++];
+        payloadTransfer(NRF_R_RX_PAYLOAD, NULL, packet->data, len, true);
+        packet->pipe = pipe;
+        packet->length = len;
+        recordRx(pipe, len);
+    }
+    if (count >= NRF_RX_FIFO_DEPTH) {
+        stats.rx_fifo_full++;
+    }
+    return count;
+}
+
+// Interrupt-fed RX buffering
+bool NRF24::enableRxBuffer(NRF24_Packet *storage, uint16_t count)
+{
+    if (!storage || count < 2) return false;
+    
+    disableRxBuffer();
+    rx_ring.init(storage, count);
+    stats.rx_ring_overflows = 0;
+    unmaskInterrupt(NRF_CONFIG_MASK_RX_DR);
+    return enableInterrupts();
+}
+
+void NRF24::disableRxBuffer()
+{
+    // Detach first so a concurrent ISR stops producing before the storage goes away
+    uint32_t irq_state = transport->enterCritical();
+    rx_ring.init(NULL, 0);
+    transport->exitCritical(irq_state);
+}
+
+bool NRF24::receive(NRF24_Packet *packet)
+{
+    return rx_ring.pop(*packet);
+}
+
+uint16_t NRF24::rxBuffered()
+{
+    return rx_ring.count();
+}
+
+uint32_t NRF24::getRxOverflows()
+{
+    return stats.rx_ring_overflows;
+}
+
+bool NRF24::isRxBufferEnabled()
+{
+    return rx_ring.capacity() > 0;
+}
+
+// Per-pipe ACK payload queues
+bool NRF24::enableAckQueue(uint8_t pipe, NRF24_AckPayload *storage, uint16_t count)
+{
+    if (pipe >= NRF_MAX_PIPES || !storage || count < 2) return false;
+    
+    disableAckQueue(pipe);
+    uint32_t irq_state = transport->enterCritical();
+    ack_queues[pipe].init(storage, count);
+    ack_queue_pipes |= (1 << pipe);
+    transport->exitCritical(irq_state);
+    
+    enableAckPayload();
+    
+    // TX_DS on the PRX marks a freed slot; without an IRQ line use updateAckPayloads()
+    unmaskInterrupt(NRF_CONFIG_MASK_TX_DS);
+    enableInterrupts();
+    return true;
+}
+
+// Payloads already staged stay in the chip and go out with the next ACKs
+void NRF24::disableAckQueue(uint8_t pipe)
+{
+    if (pipe >= NRF_MAX_PIPES) return;
+    
+    uint32_t irq_state = transport->enterCritical();
+    ack_queues[pipe].init(NULL, 0);
+    ack_staged[pipe] = 0;
+    ack_queue_pipes &= ~(1 << pipe);
+    transport->exitCritical(irq_state);
+}
+
+bool NRF24::queueAckPayload(uint8_t pipe, const uint8_t *data, uint8_t len)
+{
+    if (pipe >= NRF_MAX_PIPES || len > NRF_MAX_PAYLOAD_SIZE) return false;
+    
+    NRF24_AckPayload *slot = ack_queues[pipe].reserve();
+    if (!slot) return false;
+    memcpy(slot->data, data, len);
+    slot->length = len;
+    ack_queues[pipe].commit();
+    
+    if (radio_state == NRF24_STATE_RX) {
+        updateAckPayloads();
+    }
+    return true;
+}
+
+uint16_t NRF24::ackQueued(uint8_t pipe)
+{
+    if (pipe >= NRF_MAX_PIPES) return 0;
+    return ack_queues[pipe].count();
+}
+
+// Runs the IRQ service path, so it is safe against a concurrent interrupt
+void NRF24::updateAckPayloads()
+{
+    handleInterrupt();
+}
+
+// Fill every free TX FIFO slot. The pipe with the fewest payloads already staged
+// goes first (round-robin on ties), so the 3 slots spread over the pipes that have
+// data instead of all going to one. TX_FULL, not the staged counts, decides whether
+// there is room.
+void NRF24::refillAckPayloads()
+{
+    while (!(status & NRF_STATUS_TX_FULL)) {
+        uint8_t best = NRF_MAX_PIPES;
+        for (uint8_t i = 0; i < NRF_MAX_PIPES; i++) {
+            uint8_t pipe = (ack_next_pipe + i) % NRF_MAX_PIPES;
+            if (ack_queues[pipe].count() <= ack_staged[pipe]) continue;
+            if (best == NRF_MAX_PIPES || ack_staged[pipe] < ack_staged[best]) {
+                best = pipe;
+            }
+        }
+        if (best == NRF_MAX_PIPES) return;
+        
+        NRF24_AckPayload *entry = ack_queues[best].peek(ack_staged[best]);
+        payloadTransfer(NRF_W_ACK_PAYLOAD | best, entry->data, NULL, entry->length, true);
+        ack_staged[best]++;
+        ack_next_pipe = (best + 1) % NRF_MAX_PIPES;
+        sendCommand(NRF_NOP);  // The write's own STATUS predates it
+    }
+}
+
+// A packet arrived on a pipe with a staged payload, so its ACK carried the oldest one
+void NRF24::releaseAckPayload(uint8_t pipe)
+{
+    if (!pipes[pipe].auto_ack_enabled) return;
+    
+    uint32_t irq_state = transport->enterCritical();
+    if (ack_staged[pipe]) {
+        ack_staged[pipe]--;
+        ack_queues[pipe].release();
+        stats.ack_payloads++;
+    }
+    transport->exitCritical(irq_state);
+}
+
+bool NRF24::anyDynamicPayloads()
+{
+    bool any_dynamic = dynamic_payload_enabled;
+    for (uint8_t i = 0; i < NRF_MAX_PIPES; i++) {
+        any_dynamic |= pipes[i].dynamic_payload_enabled;
+    }
+    return any_dynamic;
+}
+
+// Pipe and length of the payload at the head of the RX FIFO, in one transaction that
+// also refreshes RX_P_NO. False once the FIFO is empty (or flushed over a corrupt width).
+bool NRF24::peekRxFifo(bool any_dynamic, uint8_t *pipe, uint8_t *len)
+{
+    uint8_t width = 0;
+    if (any_dynamic) {
+        transfer(NRF_R_RX_PL_WID, NULL, &width, 1);
+    } else {
+        sendCommand(NRF_NOP);
+    }
+    
+    *pipe = (status & NRF_STATUS_RX_P_NO) >> 1;
+    if (*pipe >= NRF_MAX_PIPES) return false;
+    
+    *len = pipes[*pipe].payload_size;
+    if (dynamic_payload_enabled || pipes[*pipe].dynamic_payload_enabled) {
+        if (width > NRF_MAX_PAYLOAD_SIZE) {
+            flushRx(); // Corrupt width, the datasheet says to flush
+            return false;
+        }
+        *len = width;
+    }
+    return true;
+}
+
+// Move every queued payload from the RX FIFO into the ring. Runs in IRQ context.
+void NRF24::drainRxFifo()
+{
+    bool any_dynamic = anyDynamicPayloads();
+    uint8_t pipe, len;
+    uint8_t drained = 0;
+    
+    while (peekRxFifo(any_dynamic, &pipe, &len)) {
+        NRF24_Packet *slot = rx_ring.reserve();
+        if (slot) {
+            payloadTransfer(NRF_R_RX_PAYLOAD, NULL, slot->data, len, true);
+            slot->pipe = pipe;
+            slot->length = len;
+            rx_ring.commit();
+        } else {
+            uint8_t discard[NRF_MAX_PAYLOAD_SIZE];
+            payloadTransfer(NRF_R_RX_PAYLOAD, NULL, discard, len, true);
+            stats.rx_ring_overflows++;
+        }
+        recordRx(pipe, len);
+        drained++;
+    }
+    if (drained >= NRF_RX_FIFO_DEPTH) {
+        stats.rx_fifo_full++;
+    }
+}
+
 uint8_t NRF24::getDynamicPayloadSize()
 {
     uint8_t result = 0;
-    csnLow();
-    uint8_t cmd = NRF_R_RX_PL_WID;
-    spi_write_blocking(spi, &cmd, 1);
-    spi_read_blocking(spi, 0x00, &result, 1);
-    csnHigh();
+    transfer(NRF_R_RX_PL_WID, NULL, &result, 1);
     
     if (result > NRF_MAX_PAYLOAD_SIZE) {
         flushRx();
@@ -876,20 +1867,36 @@ uint8_t NRF24::getDynamicPayloadSize()
 void NRF24::startListening()
 {
     setModeRX();
+    if (ack_queue_pipes) {
+        updateAckPayloads();
+    }
 }
 
 void NRF24::stopListening()
 {
     ceLow();
+    if (radio_state == NRF24_STATE_RX) {
+        radio_state = NRF24_STATE_STANDBY_I;
+    }
     if (readReg(NRF_FEATURE_REGISTER) & NRF_FEATURE_EN_ACK_PAY) {
-        sleep_us(130);
+        transport->delayUs(130);
+    }
+    
+    // In TX mode staged ACK payloads would go out as data packets
+    if (ack_queue_pipes) {
+        flushTx();
     }
 }
 
 // Status and diagnostics
 uint8_t NRF24::getStatus()
 {
-    return readReg(NRF_STATUS_REGISTER);
+    return sendCommand(NRF_NOP);
+}
+
+uint8_t NRF24::getLastStatus()
+{
+    return status;
 }
 
 bool NRF24::testCarrier()
@@ -902,6 +1909,18 @@ bool NRF24::testRPD()
     return testCarrier();
 }
 
+// Tune to a channel and listen for a carrier. Dropping CE clears the latched RPD, so
+// each sample covers only this channel.
+bool NRF24::sampleCarrier(uint8_t channel, uint16_t listen_us)
+{
+    setModeRX();
+    ceLow();
+    setChannel(channel);
+    ceHigh();
+    transport->delayUs(NRF24_RX_SETTLE_US + listen_us);
+    return testRPD();
+}
+
 uint8_t NRF24::getObserveTx()
 {
     return readReg(NRF_OBSERVE_TX_REGISTER);
@@ -919,10 +1938,138 @@ uint8_t NRF24::getRetransmitCount()
 
 void NRF24::resetPacketLossCounters()
 {
-    writeReg(NRF_RF_CH_REGISTER, channel); // Reset by writing to channel register
+    // Reset by writing to channel register; must reach the chip even if the shadow matches
+    writeRegDirect(NRF_RF_CH_REGISTER, &channel, 1);
 }
 
 // Interrupt handling
+void NRF24::onEvent(NRF24_Event event, NRF24_EventCallback callback, void *user_data)
+{
+    switch (event) {
+        case NRF24_EVENT_RX_READY:
+            rx_callback = callback;
+            rx_callback_data = user_data;
+            break;
+        case NRF24_EVENT_TX_DONE:
+            tx_callback = callback;
+            tx_callback_data = user_data;
+            break;
+        case NRF24_EVENT_MAX_RETRIES:
+            max_rt_callback = callback;
+            max_rt_callback_data = user_data;
+            break;
+    }
+    
+    if (callback) {
+        callback_mask |= event;
+        unmaskInterrupt(event);
+    } else {
+        callback_mask &= ~event;
+    }
+}
+
+bool NRF24::enableInterrupts()
+{
+    if (irq_enabled) return true;
+    if (!transport->attachInterrupt(onIrq, this)) return false;
+    irq_enabled = true;
+    
+    // Catch events that were already pending, as they will not produce a new edge
+    if (transport->isIrqAsserted()) {
+        handleInterrupt();
+    }
+    return true;
+}
+
+void NRF24::disableInterrupts()
+{
+    if (!irq_enabled) return;
+    
+    transport->detachInterrupt();
+    irq_enabled = false;
+}
+
+void NRF24::onIrq(void *context)
+{
+    static_cast<NRF24 *>(context)->handleInterrupt();
+}
+
+// Reads STATUS once, clears only the flags that have a callback and dispatches them.
+// Called from the GPIO ISR, or deferred to the end of a transaction it interrupted.
+void NRF24::handleInterrupt()
+{
+    if (spi_busy || irq_servicing) {
+        irq_deferred = true;
+        return;
+    }
+    irq_servicing = true;
+    
+    do {
+        irq_deferred = false;
+        serviceEvents();
+    } while (irq_deferred);
+    
+    irq_servicing = false;
+    if (irq_deferred) {
+        handleInterrupt();
+    }
+}
+
+void NRF24::serviceEvents()
+{
+    uint8_t mask = callback_mask;
+    if (rx_ring.capacity()) {
+        mask |= NRF_STATUS_RX_DR;
+    }
+    if (async_pending) {
+        mask |= NRF_STATUS_TX_DS | NRF_STATUS_MAX_RT;
+    }
+    bool ack_refill = ack_queue_pipes && radio_state == NRF24_STATE_RX;
+    if (ack_refill) {
+        mask |= NRF_STATUS_TX_DS;  // A PRX sets TX_DS when an ACK carried a payload out
+    }
+    
+    uint8_t serviced = sendCommand(NRF_NOP) & mask;
+    if (serviced) {
+        writeReg(NRF_STATUS_REGISTER, serviced);
+        tx_latched |= serviced & (NRF_STATUS_TX_DS | NRF_STATUS_MAX_RT);  // For write() and writeBlocking()
+        
+        // A stream never sees these flags again: its bookkeeping and MAX_RT policy run here
+        if (stream_active) {
+            if (serviced & (NRF_STATUS_TX_DS | NRF_STATUS_MAX_RT)) {
+                streamPoll(serviced & (NRF_STATUS_TX_DS | NRF_STATUS_MAX_RT));
+            }
+        } else if ((serviced & (NRF_STATUS_TX_DS | NRF_STATUS_MAX_RT)) && radio_state == NRF24_STATE_TX) {
+            radio_state = txIdleState();
+        }
+        if ((async_pending || tx_outstanding) && (serviced & (NRF_STATUS_TX_DS | NRF_STATUS_MAX_RT))) {
+            uint8_t observe_tx = readReg(NRF_OBSERVE_TX_REGISTER);
+            if (async_pending) {
+                finishSend((serviced & NRF_STATUS_TX_DS) ? NRF24_TX_ACKED : NRF24_TX_FAILED, observe_tx);
+            } else {
+                txComplete(serviced, observe_tx, true);
+            }
+        }
+        if ((serviced & NRF_STATUS_TX_DS) && tx_callback) {
+            tx_callback(this, tx_callback_data);
+        }
+        if ((serviced & NRF_STATUS_MAX_RT) && max_rt_callback) {
+            max_rt_callback(this, max_rt_callback_data);
+        }
+        if (serviced & NRF_STATUS_RX_DR) {
+            if (rx_ring.capacity()) {
+                drainRxFifo();
+            }
+            if (rx_callback) {
+                rx_callback(this, rx_callback_data);
+            }
+        }
+    }
+    if (ack_refill) {
+        refillAckPayloads();
+    }
+}
+
 void NRF24::maskInterrupt(uint8_t interrupt)
 {
     uint8_t config = readReg(NRF_CONFIG_REGISTER);
@@ -939,7 +2086,7 @@ void NRF24::unmaskInterrupt(uint8_t interrupt)
 
 bool NRF24::isInterruptTriggered(uint8_t interrupt)
 {
-    return (readReg(NRF_STATUS_REGISTER) & interrupt) != 0;
+    return (sendCommand(NRF_NOP) & interrupt) != 0;
 }
 
 void NRF24::clearInterrupt(uint8_t interrupt)
@@ -947,6 +2094,22 @@ void NRF24::clearInterrupt(uint8_t interrupt)
     writeReg(NRF_STATUS_REGISTER, interrupt);
 }
 
+// DMA payload transport
+bool NRF24::enableDMA()
+{
+    return transport->enableDMA();
+}
+
+void NRF24::disableDMA()
+{
+    transport->disableDMA();
+}
+
+bool NRF24::isDMAEnabled()
+{
+    return transport->isDMAEnabled();
+}
+
 // FIFO operations
 bool NRF24::isTxFifoEmpty()
 {
@@ -1000,54 +2163,161 @@ void NRF24::enterTestMode()
     setCarrierWave(true);
     setModeTX();
     ceHigh();
+    radio_state = NRF24_STATE_STANDBY_II;  // Empty FIFO with CE high; CONT_WAVE keeps the carrier up
 }
 
 void NRF24::exitTestMode()
 {
     ceLow();
+    radio_state = NRF24_STATE_STANDBY_I;
     setCarrierWave(false);
 }
 
 // Statistics
-uint16_t NRF24::getPacketsSent()
+uint32_t NRF24::getPacketsSent()
 {
-    return packets_sent;
+    return stats.tx_packets;
 }
 
-uint16_t NRF24::getPacketsReceived()
+uint32_t NRF24::getPacketsReceived()
 {
-    return packets_received;
+    uint32_t total = 0;
+    for (uint8_t i = 0; i < NRF_MAX_PIPES; i++) {
+        total += stats.rx_packets[i];
+    }
+    return total;
+}
+
+uint32_t NRF24::getPacketsLost()
+{
+    return stats.tx_failed;
 }
 
-uint16_t NRF24::getPacketsLost()
+// Snapshot taken with the IRQ handler held off, so the counters agree with each other
+void NRF24::getStats(NRF24_Stats *stats)
 {
-    return packets_lost;
+    uint32_t irq_state = transport->enterCritical();
+    *stats = this->stats;
+    transport->exitCritical(irq_state);
 }
 
 void NRF24::resetStatistics()
 {
-    packets_sent = 0;
-    packets_received = 0;
-    packets_lost = 0;
-    retransmit_count = 0;
+    uint32_t irq_state = transport->enterCritical();
+    memset(&stats, 0, sizeof(stats));
+    transport->exitCritical(irq_state);
+}
+
+// SPI transaction trace
+uint32_t NRF24::dumpTrace(uint8_t *buffer, uint32_t size)
+{
+#if NRF24_TRACE
+    return tracer.dump(buffer, size);
+#else
+    (void)buffer;
+    (void)size;
+    return 0;
+#endif
+}
+
+uint16_t NRF24::getTraceCount()
+{
+#if NRF24_TRACE
+    return tracer.count();
+#else
+    return 0;
+#endif
+}
+
+void NRF24::clearTrace()
+{
+#if NRF24_TRACE
+    tracer.clear();
+#endif
+}
+
+// A handful of increments and shifts, cheap enough for every completion
+void NRF24::recordTx(bool sent, uint8_t observe_tx, uint32_t latency_us)
+{
+    if (sent) {
+        stats.tx_packets++;
+    } else {
+        stats.tx_failed++;
+    }
+    
+    uint8_t arc = observe_tx & 0x0F;
+    stats.retransmits += arc;
+    stats.arc_histogram[arc]++;
+    
+    if (latency_us != NRF24_LATENCY_UNKNOWN) {
+        uint8_t bucket = 0;
+        latency_us >>= NRF24_LATENCY_SHIFT;
+        while (latency_us && bucket < NRF24_LATENCY_BUCKETS - 1) {
+            latency_us >>= 1;
+            bucket++;
+        }
+        stats.latency_histogram[bucket]++;
+    }
+}
+
+// Account for the startWrite() packet in flight once its outcome shows up. Outcomes
+// only found as stale flags by the next write have no meaningful latency.
+void NRF24::txComplete(uint8_t flags, uint8_t observe_tx, bool timed)
+{
+    if (!tx_outstanding) return;
+    tx_outstanding = false;
+    recordTx((flags & NRF_STATUS_TX_DS) != 0, observe_tx, timed ? transport->micros() - tx_start_us : NRF24_LATENCY_UNKNOWN);
+}
+
+// Shadow register cache
+void NRF24::enableShadowRegisters(bool enable)
+{
+    if (enable && !shadow_enabled) {
+        resyncShadow();
+    }
+    shadow_enabled = enable;
+}
+
+bool NRF24::isShadowEnabled()
+{
+    return shadow_enabled;
+}
+
+void NRF24::resyncShadow()
+{
+    for (uint8_t reg = 0; reg <= NRF_FEATURE_REGISTER; reg++) {
+        if (isShadowed(reg)) {
+            shadow_regs[reg] = readRegDirect(reg);
+        }
+    }
+}
+
+void NRF24::setShadowVerify(bool enable)
+{
+    shadow_verify = enable;
+}
+
+uint16_t NRF24::getShadowMismatches()
+{
+    return shadow_mismatches;
 }
 
 // Print detailed information about the module
 void NRF24::printDetails()
 {
     printf("NRF24L01%s Details:\n", is_plus_variant ? "+" : "");
-    printf("STATUS: 0x%02X\n", readReg(NRF_STATUS_REGISTER));
-    printf("CONFIG: 0x%02X\n", readReg(NRF_CONFIG_REGISTER));
-    printf("EN_AA: 0x%02X\n", readReg(NRF_EN_AA_REGISTER));
-    printf("EN_RXADDR: 0x%02X\n", readReg(NRF_EN_RXADDR_REGISTER));
-    printf("SETUP_AW: 0x%02X\n", readReg(NRF_SETUP_AW_REGISTER));
-    printf("SETUP_RETR: 0x%02X\n", readReg(NRF_SETUP_RETR_REGISTER));
-    printf("RF_CH: %d\n", readReg(NRF_RF_CH_REGISTER));
-    printf("RF_SETUP: 0x%02X\n", readReg(NRF_RF_SETUP_REGISTER));
-    printf("OBSERVE_TX: 0x%02X\n", readReg(NRF_OBSERVE_TX_REGISTER));
-    printf("FIFO_STATUS: 0x%02X\n", readReg(NRF_FIFO_STATUS_REGISTER));
-    printf("DYNPD: 0x%02X\n", readReg(NRF_DYNPD_REGISTER));
-    printf("FEATURE: 0x%02X\n", readReg(NRF_FEATURE_REGISTER));
+    printf("STATUS: 0x%02X\n", readRegDirect(NRF_STATUS_REGISTER));
+    printf("CONFIG: 0x%02X\n", readRegDirect(NRF_CONFIG_REGISTER));
+    printf("EN_AA: 0x%02X\n", readRegDirect(NRF_EN_AA_REGISTER));
+    printf("EN_RXADDR: 0x%02X\n", readRegDirect(NRF_EN_RXADDR_REGISTER));
+    printf("SETUP_AW: 0x%02X\n", readRegDirect(NRF_SETUP_AW_REGISTER));
+    printf("SETUP_RETR: 0x%02X\n", readRegDirect(NRF_SETUP_RETR_REGISTER));
+    printf("RF_CH: %d\n", readRegDirect(NRF_RF_CH_REGISTER));
+    printf("RF_SETUP: 0x%02X\n", readRegDirect(NRF_RF_SETUP_REGISTER));
+    printf("OBSERVE_TX: 0x%02X\n", readRegDirect(NRF_OBSERVE_TX_REGISTER));
+    printf("FIFO_STATUS: 0x%02X\n", readRegDirect(NRF_FIFO_STATUS_REGISTER));
+    printf("DYNPD: 0x%02X\n", readRegDirect(NRF_DYNPD_REGISTER));
+    printf("FEATURE: 0x%02X\n", readRegDirect(NRF_FEATURE_REGISTER));
     
     printf("\nData Rate: ");
     switch (getDataRate()) {
@@ -1099,9 +2369,13 @@ void NRF24::printDetails()
     }
     
     printf("\nStatistics:\n");
-    printf("Packets Sent: %d\n", packets_sent);
-    printf("Packets Received: %d\n", packets_received);
-    printf("Packets Lost: %d\n", packets_lost);
+    printf("Packets Sent: %lu\n", (unsigned long)stats.tx_packets);
+    printf("Packets Received: %lu\n", (unsigned long)getPacketsReceived());
+    printf("Packets Lost: %lu\n", (unsigned long)stats.tx_failed);
+    printf("Retransmits: %lu\n", (unsigned long)stats.retransmits);
+    if (ack_queue_pipes) {
+        printf("ACK Payloads Sent: %lu\n", (unsigned long)stats.ack_payloads);
+    }
 }
 
 // Compatibility functions (for backward compatibility)
@@ -1115,13 +2389,14 @@ void NRF24::config(uint8_t *address, uint8_t channel, uint8_t messageLen)
     this->channel = channel;
     this->messageLen = messageLen;
     
-    csnHigh();
     ceLow();
-    sleep_ms(11);
+    transport->delayUs(11000);
     
     // Basic configuration
     writeReg(NRF_CONFIG_REGISTER, NRF_CONFIG_EN_CRC | NRF_CONFIG_CRCO | NRF_CONFIG_PWR_UP);
-    sleep_us(1500);
+    transport->delayUs(1500);
+    radio_state = NRF24_STATE_STANDBY_I;
+    prim_rx = false;
     
     // Disable auto-ack by default for compatibility
     writeReg(NRF_EN_AA_REGISTER, 0x00);
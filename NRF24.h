@@ -2,10 +2,13 @@
 #ifndef __NRF24_H_
 #define __NRF24_H_
 
+#include "NRF24_Transport.h"
+#include "NRF24_Trace.h"
+#if NRF24_PICO
 #include "pico/stdlib.h"
 #include "pico/stdio.h"
-#include "hardware/spi.h"
-#include "hardware/gpio.h"
+#include "NRF24_PicoTransport.h"
+#endif
 
 // NRF24L01 Register addresses
 #define NRF_CONFIG_REGISTER         0x00
@@ -89,6 +92,42 @@
 #define NRF_MIN_ADDR_SIZE           3
 #define NRF_MAX_CHANNEL             125
 #define NRF_MAX_PIPES               6
+#define NRF_RX_FIFO_DEPTH           3
+
+// Chip timing from the datasheet
+#define NRF24_POWER_ON_RESET_US     10300  // VDD applied to power down state
+#define NRF24_POWER_UP_US           1500   // Tpd2stby, power down to standby
+#define NRF24_CE_PULSE_US           15     // CE high time that starts a transmission (min 10)
+
+// Carrier sampling: RX settling after CE rises, and the minimum signal time RPD needs
+#define NRF24_RX_SETTLE_US          130
+#define NRF24_RPD_MIN_US            40
+
+// Airtime model: preamble, address, 9-bit packet control field, payload and CRC
+#define NRF24_PREAMBLE_BYTES        1
+#define NRF24_PCF_BITS              9
+#define NRF24_TX_SETTLE_US          130    // Tstby2a; also the PTX/PRX turnaround around an ACK
+#define NRF24_TX_DEADLINE_MARGIN_US 100    // SPI and MCU latency on top of the model
+
+// Statistics: TX completion latency in log2 buckets (bucket 0 is under 128 us, the last
+// is open-ended) and completions by ARC
+#define NRF24_LATENCY_BUCKETS       10
+#define NRF24_LATENCY_SHIFT         7
+#define NRF24_LATENCY_UNKNOWN       0xFFFFFFFF
+#define NRF24_ARC_BUCKETS           16
+
+// Streaming TX
+#define NRF_TX_FIFO_DEPTH           3
+#define NRF24_STREAM_TIMEOUT_MS     10
+#define NRF24_STREAM_LOG_SIZE       256  // Packets whose outcome stays queryable
+
+
+// Configuration registers mirrored by the optional shadow cache
+#define NRF_SHADOW_REGISTER_MASK    ((1UL << NRF_CONFIG_REGISTER) | (1UL << NRF_EN_AA_REGISTER) | \
+                                     (1UL << NRF_EN_RXADDR_REGISTER) | (1UL << NRF_SETUP_AW_REGISTER) | \
+                                     (1UL << NRF_SETUP_RETR_REGISTER) | (1UL << NRF_RF_CH_REGISTER) | \
+                                     (1UL << NRF_RF_SETUP_REGISTER) | (1UL << NRF_DYNPD_REGISTER) | \
+                                     (1UL << NRF_FEATURE_REGISTER))
 
 // Enums for better code readability
 enum NRF24_DataRate {
@@ -135,6 +174,167 @@ enum NRF24_AutoRetransmitDelay {
     NRF24_ARD_4000US = 15
 };
 
+// Radio operating states as tracked by the driver
+enum NRF24_RadioState {
+    NRF24_STATE_POWER_DOWN = 0,
+    NRF24_STATE_STANDBY_I = 1,   // Powered up, CE low
+    NRF24_STATE_STANDBY_II = 2,  // PTX with CE high and an empty TX FIFO
+    NRF24_STATE_TX = 3,
+    NRF24_STATE_RX = 4
+};
+
+// Events dispatched by the IRQ engine (values match the STATUS flags)
+enum NRF24_Event {
+    NRF24_EVENT_RX_READY = NRF_STATUS_RX_DR,
+    NRF24_EVENT_TX_DONE = NRF_STATUS_TX_DS,
+    NRF24_EVENT_MAX_RETRIES = NRF_STATUS_MAX_RT
+};
+
+// What streaming TX does when the head packet hits MAX_RT
+enum NRF24_StreamPolicy {
+    NRF24_STREAM_REUSE = 0,  // Retransmit the head packet, up to the reuse limit
+    NRF24_STREAM_FLUSH = 1   // Drop everything queued in the TX FIFO
+};
+
+enum NRF24_TxOutcome {
+    NRF24_TX_PENDING = 0,
+    NRF24_TX_ACKED = 1,
+    NRF24_TX_FAILED = 2,
+    NRF24_TX_UNKNOWN = 3,    // Never queued, or older than the outcome log
+    NRF24_TX_TIMEOUT = 4     // Neither TX_DS nor MAX_RT before the deadline
+};
+
+// Per-stream counters, reset by the first writeFast() after txStandBy()
+typedef struct {
+    uint32_t queued;
+    uint32_t acked;
+    uint32_t dropped;
+    uint16_t max_rt_events;
+    uint16_t reuses;
+} NRF24_StreamReport;
+
+// Cumulative driver statistics. 32-bit, so they do not wrap at sustained rates.
+typedef struct {
+    uint32_t rx_packets[NRF_MAX_PIPES];
+    uint32_t rx_bytes[NRF_MAX_PIPES];
+    uint32_t rx_fifo_full;        // Drains that found all 3 RX FIFO slots used (the chip drops further arrivals)
+    uint32_t rx_ring_overflows;   // Payloads the RX ring had no room for
+    uint32_t ack_payloads;        // Queued ACK payloads that went out with an ACK
+    uint32_t tx_packets;          // TX_DS: ACKed, or sent for no-ACK packets
+    uint32_t tx_failed;           // MAX_RT, timeouts and dropped stream packets
+    uint32_t retransmits;         // Sum of ARC over all completions
+    uint32_t arc_histogram[NRF24_ARC_BUCKETS];
+    uint32_t latency_histogram[NRF24_LATENCY_BUCKETS];
+} NRF24_Stats;
+
+// Received payload as buffered by the RX ring
+typedef struct {
+    uint8_t pipe;
+    uint8_t length;
+    uint8_t data[NRF_MAX_PAYLOAD_SIZE];
+} NRF24_Packet;
+
+// ACK payload waiting in a per-pipe queue
+typedef struct {
+    uint8_t length;
+    uint8_t data[NRF_MAX_PAYLOAD_SIZE];
+} NRF24_AckPayload;
+
+// Lock-free single-producer/single-consumer ring over caller-provided storage.
+// Either side may run in an ISR or on the other core; each index has one writer.
+// One slot is kept free, so a ring over N slots holds N - 1 items.
+template <typename T>
+class NRF24_Ring
+{
+private:
+    T *slots;
+    uint16_t size;
+    volatile uint16_t head;  // Written by the producer
+    volatile uint16_t tail;  // Written by the consumer
+
+public:
+    NRF24_Ring() : slots(NULL), size(0), head(0), tail(0) {}
+    
+    void init(T *storage, uint16_t count)
+    {
+        slots = storage;
+        size = count;
+        head = 0;
+        tail = 0;
+    }
+    
+    uint16_t capacity() { return size ? size - 1 : 0; }
+    uint16_t count() { uint16_t h = head, t = tail; return (h >= t) ? h - t : size - t + h; }
+    bool isEmpty() { return head == tail; }
+    
+    // Producer: claim the next free slot, fill it in place, then commit()
+    T *reserve()
+    {
+        if (!size) return NULL;
+        uint16_t next = (head + 1 == size) ? 0 : head + 1;
+        return (next == tail) ? NULL : &slots[head];
+    }
+    
+    void commit()
+    {
+        NRF24_MEMORY_BARRIER(); // Slot contents visible before the index moves
+        head = (head + 1 == size) ? 0 : head + 1;
+    }
+    
+    bool push(const T &item)
+    {
+        T *slot = reserve();
+        if (!slot) return false;
+        *slot = item;
+        commit();
+        return true;
+    }
+    
+    // Consumer: look at the oldest item in place, then release()
+    T *peek()
+    {
+        if (head == tail) return NULL;
+        NRF24_MEMORY_BARRIER(); // Pairs with commit()
+        return &slots[tail];
+    }
+    
+    // Consumer: the index-th oldest item, NULL if fewer are queued
+    T *peek(uint16_t index)
+    {
+        if (index >= count()) return NULL;
+        NRF24_MEMORY_BARRIER(); // Pairs with commit()
+        uint16_t slot = tail + index;
+        return &slots[slot >= size ? slot - size : slot];
+    }
+    
+    void release()
+    {
+        NRF24_MEMORY_BARRIER(); // Finish reading the slot before handing it back
+        tail = (tail + 1 == size) ? 0 : tail + 1;
+    }
+    
+    bool pop(T &item)
+    {
+        T *slot = peek();
+        if (!slot) return false;
+        item = *slot;
+        release();
+        return true;
+    }
+};
+
+// Outcome of one sendAsync() packet
+typedef struct {
+    uint16_t handle;
+    NRF24_TxOutcome outcome;
+    uint8_t retransmits;     // ARC from OBSERVE_TX
+    uint32_t elapsed_us;
+} NRF24_SendResult;
+
+class NRF24;
+typedef void (*NRF24_EventCallback)(NRF24 *radio, void *user_data);
+typedef void (*NRF24_SendCallback)(NRF24 *radio, const NRF24_SendResult *result, void *user_data);
+
 // Structure to hold pipe configuration
 typedef struct {
     uint8_t address[NRF_MAX_ADDR_SIZE];
@@ -146,17 +346,35 @@ typedef struct {
 
 
 
+// Complete radio configuration for begin(config). Start from getDefaultConfig(),
+// which matches the chip's reset values, so unchanged fields cost no SPI writes.
+typedef struct {
+    uint8_t channel;
+    NRF24_DataRate data_rate;
+    NRF24_PowerLevel power_level;
+    NRF24_CRCLength crc_length;
+    NRF24_AddressWidth address_width;
+    NRF24_AutoRetransmitDelay retry_delay;
+    uint8_t retry_count;
+    uint8_t payload_size;         // Static payload width of pipes 0 and 1
+    uint8_t auto_ack_pipes;       // EN_AA bitmap
+    bool dynamic_payloads;
+    bool ack_payloads;            // Needs dynamic_payloads
+    bool dynamic_ack;
+    const uint8_t *tx_address;    // Also pipe 0 for auto-ack; NULL keeps the chip's
+    const uint8_t *rx_address;    // Pipe 1; NULL keeps the chip's
+    bool listen;                  // End in RX mode instead of standby-I
+    uint32_t power_on_us;         // Transport time the radio was powered (0: with the MCU)
+} NRF24_Config;
+
 class NRF24
 {
 private: // Private variables
-    spi_inst_t *spi;
-    uint16_t sck;
-    uint16_t miso;    
-    uint16_t mosi;
-    uint16_t csn;
-    uint16_t ce;
-    uint16_t irq;
-    
+    NRF24_Transport *transport;
+#if NRF24_PICO
+    NRF24_PicoTransport pico_transport;
+#endif
+
     uint8_t status;
     uint8_t fifo_status;
     uint8_t payload_size;
@@ -171,34 +389,117 @@ private: // Private variables
     bool auto_ack_enabled;
     bool is_plus_variant;
     
+    // Tracked radio state, so mode switches only touch the chip on change
+    NRF24_RadioState radio_state;
+    bool prim_rx;
+    volatile bool ce_high;      // Level last driven on CE
+    
+    // PWR_UP time, so the oscillator startup is only waited out when CE has to rise
+    uint32_t power_up_us;
+    bool power_up_pending;
+    
+    // Write-through shadow copy of the configuration registers
+    uint8_t shadow_regs[NRF_FEATURE_REGISTER + 1];
+    bool shadow_enabled;
+    bool shadow_verify;
+    uint16_t shadow_mismatches;
+    
+    // IRQ engine
+    NRF24_EventCallback rx_callback;
+    NRF24_EventCallback tx_callback;
+    NRF24_EventCallback max_rt_callback;
+    void *rx_callback_data;
+    void *tx_callback_data;
+    void *max_rt_callback_data;
+    uint8_t callback_mask;
+    bool irq_enabled;
+    volatile bool spi_busy;
+    volatile bool irq_deferred;
+    volatile bool irq_servicing;
+    
+    // Channel hop requested from an alarm ISR while a transaction was in flight
+    volatile bool hop_deferred;
+    volatile uint8_t hop_channel;
+    
+    // DMA payload transport: startWrite() work left to the completion handler
+    bool dma_ce_pulse;
+    bool dma_clear_stale;
+    
+    // Streaming TX
+    bool stream_active;
+    NRF24_StreamPolicy stream_policy;
+    uint8_t stream_max_reuse;
+    uint8_t stream_reuse_count;
+    uint8_t stream_in_fifo;   // Upper bound on packets still in the TX FIFO
+    volatile bool stream_dropped;  // Drops writeFast() has not reported yet
+    NRF24_StreamReport stream_report;
+    uint8_t stream_failed_map[NRF24_STREAM_LOG_SIZE / 8];
+    
+    // Asynchronous TX: one packet in flight, finished by poll() or the IRQ engine
+    volatile bool async_pending;
+    uint16_t async_handle;
+    uint32_t async_start_us;
+    uint32_t async_timeout_us;
+    NRF24_SendResult async_result;
+    NRF24_SendCallback send_callback;
+    void *send_callback_data;
+    
+    // ISR-fed RX ring
+    NRF24_Ring<NRF24_Packet> rx_ring;
+    
+    // ACK payload queues. The oldest ack_staged[pipe] entries of a queue are in the
+    // chip's TX FIFO and leave the queue when a packet arrives on that pipe.
+    NRF24_Ring<NRF24_AckPayload> ack_queues[NRF_MAX_PIPES];
+    uint8_t ack_staged[NRF_MAX_PIPES];
+    uint8_t ack_queue_pipes;      // Pipes with a queue attached
+    uint8_t ack_next_pipe;        // Round-robin start for the next free slot
+    
     NRF24_Pipe pipes[NRF_MAX_PIPES];
     uint8_t rx_pipe_enabled;
     uint8_t tx_address[NRF_MAX_ADDR_SIZE];
-    
-    // Statistics
-    uint16_t packets_lost;
-    uint16_t packets_sent;
-    uint16_t packets_received;
-    uint8_t retransmit_count;
+
+#if NRF24_TRACE
+    NRF24_Tracer tracer;
+#endif
+
+    // Statistics, plus the startWrite() packet whose outcome has not been seen yet
+    NRF24_Stats stats;
+    volatile bool tx_outstanding;
+    uint32_t tx_start_us;
+    volatile uint8_t tx_latched;    // TX_DS/MAX_RT already cleared by the IRQ engine
 
 public: // Public variables (for compatibility)
     uint8_t messageLen = 32;  // Default to max payload size
     uint16_t packetsLost = 0;
 
 private: // Private functions
-    // Low-level GPIO control
-    void csnLow() { gpio_put(csn, 0); }
-    void csnHigh() { gpio_put(csn, 1); }
-    void ceLow() { gpio_put(ce, 0); }
-    void ceHigh() { gpio_put(ce, 1); }
+    void init(NRF24_Transport *transport);
+    
+    // Low-level CE control
+    void ceLow() { transport->waitTransfer(); transport->setCE(false); ce_high = false; }
+    void ceHigh() { if (power_up_pending) waitPowerUp(); transport->setCE(true); ce_high = true; }
+    void cePulse();
     
-    // Low-level register operations
+    // Where a PTX goes once TX_DS / MAX_RT ends the packet: standby-II while CE stays high
+    NRF24_RadioState txIdleState() { return ce_high ? NRF24_STATE_STANDBY_II : NRF24_STATE_STANDBY_I; }
+    
+    // Low-level register operations (every transaction refreshes the cached STATUS)
+    uint8_t transfer(uint8_t cmd, uint8_t *tx, uint8_t *rx, uint8_t len);
     uint8_t readReg(uint8_t reg);
     void writeReg(uint8_t reg, uint8_t data);
     void writeReg(uint8_t reg, uint8_t *data, uint8_t size);
+    uint8_t readRegDirect(uint8_t reg);
+    void writeRegDirect(uint8_t reg, uint8_t *data, uint8_t size);
+    bool isShadowed(uint8_t reg);
     void writeCommand(uint8_t cmd);
     uint8_t sendCommand(uint8_t cmd);
     
+    // DMA payload transport
+    void payloadTransfer(uint8_t cmd, uint8_t *tx, uint8_t *rx, uint8_t len, bool wait);
+    void transferComplete(uint8_t status);
+    static void onTransferComplete(void *context, uint8_t status);
+    static void onIrq(void *context);
+    
     // Internal utility functions
     void flushTx();
     void flushRx();
@@ -208,20 +509,56 @@ private: // Private functions
     void powerDown();
     void activateFeatures();
     bool isChipConnected();
+    void waitPowerUp();
+    bool validateConfig(const NRF24_Config &config);
+    void applyRegister(uint8_t reg, uint8_t value);
+    void applyAddress(uint8_t reg, const uint8_t *address, uint8_t width);
+    void serviceEvents();
+    void drainRxFifo();
+    bool anyDynamicPayloads();
+    bool peekRxFifo(bool any_dynamic, uint8_t *pipe, uint8_t *len);
+    bool streamPoll(uint8_t flags);
+    void streamDrop();
+    void finishSend(NRF24_TxOutcome outcome, uint8_t observe_tx);
+    void recordTx(bool sent, uint8_t observe_tx, uint32_t latency_us);
+    void txComplete(uint8_t flags, uint8_t observe_tx, bool timed);
+    void recordRx(uint8_t pipe, uint8_t len)
+    {
+        if (pipe < NRF_MAX_PIPES) {
+            stats.rx_packets[pipe]++;
+            stats.rx_bytes[pipe] += len;
+            if (ack_staged[pipe]) releaseAckPayload(pipe);
+        }
+    }
+    void refillAckPayloads();
+    void releaseAckPayload(uint8_t pipe);
     void setRegisterBit(uint8_t reg, uint8_t bit, bool value);
     bool getRegisterBit(uint8_t reg, uint8_t bit);
 
 public: // Public functions
-    // Constructor and destructor
+    // Constructors and destructor
+#if NRF24_PICO
     NRF24(spi_inst_t *spi, uint16_t sck, uint16_t mosi, uint16_t miso, uint16_t csn, uint16_t ce, uint16_t irq);
+#endif
+    NRF24(NRF24_Transport *transport);
     ~NRF24();
-
+    NRF24_Transport *getTransport();
+    
     // Basic initialization and configuration
     bool begin();
+    bool begin(const NRF24_Config &config);  // Fast boot: no fixed sleeps, only changed registers
+    static void getDefaultConfig(NRF24_Config *config);
     bool isConnected();
     void reset();
     void printDetails();
     
+    // Shadow register cache
+    void enableShadowRegisters(bool enable);
+    bool isShadowEnabled();
+    void resyncShadow();
+    void setShadowVerify(bool enable);
+    uint16_t getShadowMismatches();
+    
     // Power management
     void setPowerUp(bool power_up);
     bool isPoweredUp();
@@ -232,12 +569,14 @@ public: // Public functions
     void setModeStandby();
     bool isModeTX();
     bool isModeRX();
+    NRF24_RadioState getRadioState();
     
     // Channel and frequency
     void setChannel(uint8_t channel);
     uint8_t getChannel();
     void setFrequency(uint16_t frequency_mhz);
     uint16_t getFrequency();
+    void hopToChannel(uint8_t channel);  // Callable from a timer ISR
     
     // Data rate configuration
     void setDataRate(NRF24_DataRate rate);
@@ -292,6 +631,10 @@ public: // Public functions
     void disableAckPayload();
     void writeAckPayload(uint8_t pipe, uint8_t *data, uint8_t len);
     
+    // Per-packet no-ACK (required for multicast writes)
+    void enableDynamicAck();
+    void disableDynamicAck();
+    
     // Data transmission
     bool write(uint8_t *data, uint8_t len);
     bool write(uint8_t *data, uint8_t len, bool multicast);
@@ -299,29 +642,76 @@ public: // Public functions
     void startWrite(uint8_t *data, uint8_t len, bool multicast);
     bool writeBlocking(uint8_t *data, uint8_t len, uint32_t timeout_ms);
     
+    // Airtime model and the worst-case time from CE to TX_DS / MAX_RT it implies
+    static uint32_t airtimeUs(NRF24_DataRate rate, uint8_t address_width, uint8_t payload_len, NRF24_CRCLength crc);
+    uint32_t getAirtimeUs(uint8_t payload_len);
+    uint32_t getAckAirtimeUs();
+    uint32_t getTxDeadlineUs(uint8_t payload_len, bool multicast = false);
+    
+    // Streaming transmission (CE held high, TX FIFO kept full)
+    void setStreamPolicy(NRF24_StreamPolicy policy, uint8_t max_reuse = 3);
+    bool writeFast(uint8_t *data, uint8_t len, bool multicast = false);  // false: not queued (full or drops)
+    bool txStandBy(uint32_t timeout_ms);
+    void getStreamReport(NRF24_StreamReport *report);
+    NRF24_TxOutcome getStreamOutcome(uint32_t seq);
+    
+    // Asynchronous transmission (returns a handle, 0 if a send is still in flight)
+    uint16_t sendAsync(uint8_t *data, uint8_t len, bool multicast = false, uint32_t timeout_us = 0);  // 0: getTxDeadlineUs()
+    NRF24_TxOutcome poll();
+    NRF24_TxOutcome getSendOutcome(uint16_t handle, NRF24_SendResult *result = NULL);
+    bool isSendPending();
+    void onSendComplete(NRF24_SendCallback callback, void *user_data = NULL);
+    
     // Data reception
     bool available();
     bool available(uint8_t *pipe_num);
     uint8_t read(uint8_t *data, uint8_t len);
+    uint8_t readBurst(NRF24_Packet *packets, uint8_t max = NRF_RX_FIFO_DEPTH);  // Whole RX FIFO, RX_DR cleared once
     uint8_t getDynamicPayloadSize();
     void startListening();
     void stopListening();
     
+    // Interrupt-fed RX buffering
+    bool enableRxBuffer(NRF24_Packet *storage, uint16_t count);
+    void disableRxBuffer();
+    bool receive(NRF24_Packet *packet);
+    uint16_t rxBuffered();
+    uint32_t getRxOverflows();
+    bool isRxBufferEnabled();
+    
+    // Per-pipe ACK payload queues, topped up into the TX FIFO as ACKs carry them out
+    bool enableAckQueue(uint8_t pipe, NRF24_AckPayload *storage, uint16_t count);
+    void disableAckQueue(uint8_t pipe);
+    bool queueAckPayload(uint8_t pipe, const uint8_t *data, uint8_t len);
+    uint16_t ackQueued(uint8_t pipe);   // Waiting plus staged in the chip
+    void updateAckPayloads();           // Polled top-up; the IRQ does this itself
+    
     // Status and diagnostics
     uint8_t getStatus();
+    uint8_t getLastStatus();
     bool testCarrier();
     bool testRPD();
+    bool sampleCarrier(uint8_t channel, uint16_t listen_us = NRF24_RPD_MIN_US);
     uint8_t getObserveTx();
     uint8_t getLostPackets();
     uint8_t getRetransmitCount();
     void resetPacketLossCounters();
     
     // Interrupt handling
+    void onEvent(NRF24_Event event, NRF24_EventCallback callback, void *user_data = NULL);
+    bool enableInterrupts();
+    void disableInterrupts();
+    void handleInterrupt();
     void maskInterrupt(uint8_t interrupt);
     void unmaskInterrupt(uint8_t interrupt);
     bool isInterruptTriggered(uint8_t interrupt);
     void clearInterrupt(uint8_t interrupt);
     
+    // DMA payload transport
+    bool enableDMA();
+    void disableDMA();
+    bool isDMAEnabled();
+    
     // FIFO operations
     bool isTxFifoEmpty();
     bool isTxFifoFull();
@@ -337,11 +727,17 @@ public: // Public functions
     void exitTestMode();
     
     // Statistics
-    uint16_t getPacketsSent();
-    uint16_t getPacketsReceived();
-    uint16_t getPacketsLost();
+    uint32_t getPacketsSent();
+    uint32_t getPacketsReceived();
+    uint32_t getPacketsLost();
+    void getStats(NRF24_Stats *stats);
     void resetStatistics();
     
+    // SPI transaction trace (empty unless built with NRF24_TRACE=1)
+    uint32_t dumpTrace(uint8_t *buffer, uint32_t size);
+    uint16_t getTraceCount();
+    void clearTrace();
+    
     // Compatibility functions (for backward compatibility)
     void enableAck(uint8_t ack);
     void config(uint8_t *address, uint8_t channel = 2, uint8_t messageLen = 32);
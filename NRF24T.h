@@ -0,0 +1,346 @@
+
+#ifndef __NRF24T_H_
+#define __NRF24T_H_
+
+#include "NRF24.h"
+
+#if !NRF24_PICO
+#error "NRF24T drives the Pico SPI and SIO directly; use NRF24 with a transport elsewhere"
+#endif
+
+#include "hardware/spi.h"
+#include "hardware/gpio.h"
+
+// Features an NRF24T instantiation keeps; everything else is compiled out
+#define NRF24_FEATURE_DYNAMIC_PAYLOAD   0x01  // R_RX_PL_WID on every read, DYNPD on all pipes
+#define NRF24_FEATURE_ACK_PAYLOAD       0x02  // writeAckPayload(), implies dynamic payloads
+#define NRF24_FEATURE_DYNAMIC_ACK       0x04  // write(..., multicast = true)
+#define NRF24_FEATURE_STATS             0x08  // getStats() counters
+#define NRF24_FEATURES_ALL              0x0F
+
+#define NRF24T_NO_IRQ                   0xFF
+
+typedef struct {
+    uint32_t packets_sent;
+    uint32_t packets_failed;
+    uint32_t packets_received;
+} NRF24T_Stats;
+
+// Counters exist only in instantiations that ask for them
+template <bool ENABLED>
+struct NRF24T_Counters
+{
+    NRF24T_Stats stats;
+    NRF24T_Counters() { stats.packets_sent = stats.packets_failed = stats.packets_received = 0; }
+    void sent(bool ok) { if (ok) stats.packets_sent++; else stats.packets_failed++; }
+    void received() { stats.packets_received++; }
+};
+
+template <>
+struct NRF24T_Counters<false>
+{
+    void sent(bool) {}
+    void received() {}
+};
+
+// Compile-time specialized driver: SPI instance, CSN, CE and IRQ pins are template
+// constants, so chip select and CE are single SIO stores, and feature branches on the
+// hot paths disappear. Covers the core API only (no IRQ engine, DMA, streaming or
+// shadow cache); use NRF24 for those. nRF24L01+ only.
+//
+//   NRF24T<0, 17, 20, 21, NRF24_FEATURE_DYNAMIC_PAYLOAD> radio;
+//   radio.begin(18, 19, 16);
+template <uint8_t SPI_INDEX, uint8_t CSN, uint8_t CE, uint8_t IRQ = NRF24T_NO_IRQ,
+          uint8_t FEATURES = NRF24_FEATURES_ALL>
+class NRF24T
+{
+private:
+    static const bool dynamic_payload = (FEATURES & (NRF24_FEATURE_DYNAMIC_PAYLOAD | NRF24_FEATURE_ACK_PAYLOAD)) != 0;
+    
+    uint8_t status;
+    uint8_t config_reg;      // Only register the hot paths modify
+    uint8_t payload_size;
+    uint8_t setup_retr;      // As written, for the TX deadline
+    NRF24_DataRate data_rate;
+    NRF24T_Counters<(FEATURES & NRF24_FEATURE_STATS) != 0> counters;
+    
+    static spi_inst_t *spi() { return SPI_INDEX ? spi1 : spi0; }
+    static void csnLow() { gpio_put(CSN, 0); }
+    static void csnHigh() { gpio_put(CSN, 1); }
+    static void ceLow() { gpio_put(CE, 0); }
+    static void ceHigh() { gpio_put(CE, 1); }
+    
+    uint8_t transfer(uint8_t cmd, const uint8_t *tx, uint8_t *rx, uint8_t len)
+    {
+        csnLow();
+        spi_write_read_blocking(spi(), &cmd, &status, 1);
+        if (len) {
+            if (rx) {
+                spi_read_blocking(spi(), 0xFF, rx, len);
+            } else {
+                spi_write_blocking(spi(), tx, len);
+            }
+        }
+        csnHigh();
+        return status;
+    }
+    
+    void writeReg(uint8_t reg, uint8_t value) { transfer(NRF_W_REGISTER | reg, &value, NULL, 1); }
+    void writeReg(uint8_t reg, const uint8_t *data, uint8_t len) { transfer(NRF_W_REGISTER | reg, data, NULL, len); }
+    uint8_t readReg(uint8_t reg)
+    {
+        uint8_t value;
+        transfer(NRF_R_REGISTER | reg, NULL, &value, 1);
+        return value;
+    }
+    
+    void setConfig(uint8_t value)
+    {
+        config_reg = value;
+        writeReg(NRF_CONFIG_REGISTER, value);
+    }
+    
+    void setSetupRetr(uint8_t value)
+    {
+        setup_retr = value;
+        writeReg(NRF_SETUP_RETR_REGISTER, value);
+    }
+    
+    // Packet airtime at the configured rate, with a 5-byte address and a 2-byte CRC
+    uint32_t airtimeUs(uint8_t payload_len) const
+    {
+        uint32_t bits = (NRF24_PREAMBLE_BYTES + NRF_MAX_ADDR_SIZE + payload_len + 2) * 8 + NRF24_PCF_BITS;
+        if (data_rate == NRF24_DATA_RATE_2MBPS) return (bits + 1) / 2;
+        if (data_rate == NRF24_DATA_RATE_250KBPS) return bits * 4;
+        return bits;
+    }
+    
+    // Same model as NRF24::getTxDeadlineUs(), from the SETUP_RETR value last written
+    uint32_t txDeadlineUs(uint8_t len, bool multicast) const
+    {
+        uint32_t attempt_us = NRF24_TX_SETTLE_US + airtimeUs(len);
+        if ((FEATURES & NRF24_FEATURE_DYNAMIC_ACK) && multicast) {
+            return attempt_us + NRF24_TX_DEADLINE_MARGIN_US;
+        }
+        uint32_t ard_us = ((setup_retr >> 4) + 1) * 250;
+        uint32_t ack_us = NRF24_TX_SETTLE_US + airtimeUs((FEATURES & NRF24_FEATURE_ACK_PAYLOAD) ? NRF_MAX_PAYLOAD_SIZE : 0);
+        attempt_us += (ard_us > ack_us) ? ard_us : ack_us;
+        return ((setup_retr & 0x0F) + 1) * attempt_us + NRF24_TX_DEADLINE_MARGIN_US;
+    }
+
+public:
+    NRF24T() : status(0), config_reg(NRF_CONFIG_EN_CRC), payload_size(NRF_MAX_PAYLOAD_SIZE),
+               setup_retr(0x03), data_rate(NRF24_DATA_RATE_2MBPS) {}
+    
+    // SCK/MOSI/MISO are only touched here, so they stay runtime arguments
+    bool begin(uint8_t sck, uint8_t mosi, uint8_t miso)
+    {
+        spi_init(spi(), 4000000);
+        gpio_set_function(sck, GPIO_FUNC_SPI);
+        gpio_set_function(mosi, GPIO_FUNC_SPI);
+        gpio_set_function(miso, GPIO_FUNC_SPI);
+        gpio_init(CSN);
+        gpio_init(CE);
+        gpio_set_dir(CSN, GPIO_OUT);
+        gpio_set_dir(CE, GPIO_OUT);
+        if (IRQ != NRF24T_NO_IRQ) {
+            gpio_init(IRQ);
+            gpio_set_dir(IRQ, GPIO_IN);
+            gpio_pull_up(IRQ);
+        }
+        ceLow();
+        csnHigh();
+        sleep_us(5000);
+        
+        // Check if chip is connected
+        writeReg(NRF_SETUP_AW_REGISTER, 0x03);
+        if (readReg(NRF_SETUP_AW_REGISTER) != 0x03) return false;
+        
+        // Same defaults as NRF24::reset(), plus the selected features
+        setConfig(NRF_CONFIG_EN_CRC);
+        writeReg(NRF_EN_AA_REGISTER, 0x3F);
+        writeReg(NRF_EN_RXADDR_REGISTER, 0x03);
+        setSetupRetr(0x03);
+        writeReg(NRF_RF_CH_REGISTER, 0x02);
+        writeReg(NRF_RF_SETUP_REGISTER, 0x0E);
+        data_rate = NRF24_DATA_RATE_2MBPS;
+        for (uint8_t pipe = 0; pipe < NRF_MAX_PIPES; pipe++) {
+            writeReg(NRF_RX_PW_P0_REGISTER + pipe, NRF_MAX_PAYLOAD_SIZE);
+        }
+        uint8_t feature = 0;
+        if (dynamic_payload) feature |= NRF_FEATURE_EN_DPL;
+        if (FEATURES & NRF24_FEATURE_ACK_PAYLOAD) feature |= NRF_FEATURE_EN_ACK_PAY;
+        if (FEATURES & NRF24_FEATURE_DYNAMIC_ACK) feature |= NRF_FEATURE_EN_DYN_ACK;
+        writeReg(NRF_FEATURE_REGISTER, feature);
+        writeReg(NRF_DYNPD_REGISTER, dynamic_payload ? 0x3F : 0x00);
+        flushTx();
+        flushRx();
+        writeReg(NRF_STATUS_REGISTER, NRF_STATUS_RX_DR | NRF_STATUS_TX_DS | NRF_STATUS_MAX_RT);
+        
+        spi_set_baudrate(spi(), 8000000);
+        return true;
+    }
+    
+    // Configuration
+    void setChannel(uint8_t channel) { writeReg(NRF_RF_CH_REGISTER, channel > NRF_MAX_CHANNEL ? NRF_MAX_CHANNEL : channel); }
+    void setRetries(uint8_t delay, uint8_t count) { setSetupRetr(((delay & 0x0F) << 4) | (count & 0x0F)); }
+    
+    void setDataRate(NRF24_DataRate rate)
+    {
+        uint8_t rf_setup = readReg(NRF_RF_SETUP_REGISTER) & ~(NRF_RF_SETUP_RF_DR_LOW | NRF_RF_SETUP_RF_DR_HIGH);
+        if (rate == NRF24_DATA_RATE_250KBPS) rf_setup |= NRF_RF_SETUP_RF_DR_LOW;
+        if (rate == NRF24_DATA_RATE_2MBPS) rf_setup |= NRF_RF_SETUP_RF_DR_HIGH;
+        writeReg(NRF_RF_SETUP_REGISTER, rf_setup);
+        data_rate = rate;
+    }
+    
+    void setPowerLevel(NRF24_PowerLevel level)
+    {
+        uint8_t rf_setup = readReg(NRF_RF_SETUP_REGISTER) & ~NRF_RF_SETUP_RF_PWR;
+        writeReg(NRF_RF_SETUP_REGISTER, rf_setup | (level << 1));
+    }
+    
+    void setPayloadSize(uint8_t size)
+    {
+        payload_size = size > NRF_MAX_PAYLOAD_SIZE ? NRF_MAX_PAYLOAD_SIZE : size;
+        for (uint8_t pipe = 0; pipe < NRF_MAX_PIPES; pipe++) {
+            writeReg(NRF_RX_PW_P0_REGISTER + pipe, payload_size);
+        }
+    }
+    
+    // Pipes (5-byte addresses; pipes 2-5 take their low byte only)
+    void openWritingPipe(const uint8_t *address)
+    {
+        writeReg(NRF_TX_ADDR_REGISTER, address, NRF_MAX_ADDR_SIZE);
+        writeReg(NRF_RX_ADDR_P0_REGISTER, address, NRF_MAX_ADDR_SIZE);
+    }
+    
+    void openReadingPipe(uint8_t pipe, const uint8_t *address)
+    {
+        if (pipe >= NRF_MAX_PIPES) return;
+        writeReg(NRF_RX_ADDR_P0_REGISTER + pipe, address, pipe < 2 ? NRF_MAX_ADDR_SIZE : 1);
+        writeReg(NRF_EN_RXADDR_REGISTER, readReg(NRF_EN_RXADDR_REGISTER) | (1 << pipe));
+    }
+    
+    // Modes
+    void startListening()
+    {
+        bool powered = config_reg & NRF_CONFIG_PWR_UP;
+        setConfig(config_reg | NRF_CONFIG_PWR_UP | NRF_CONFIG_PRIM_RX);
+        ceHigh();
+        sleep_us(powered ? NRF24_RX_SETTLE_US : NRF24_RX_SETTLE_US + NRF24_POWER_UP_US);
+    }
+    
+    void stopListening()
+    {
+        ceLow();
+        if (config_reg & NRF_CONFIG_PRIM_RX) {
+            setConfig(config_reg & ~NRF_CONFIG_PRIM_RX);
+            if (FEATURES & NRF24_FEATURE_ACK_PAYLOAD) {
+                sleep_us(NRF24_RX_SETTLE_US);
+            }
+        }
+    }
+    
+    void powerDown()
+    {
+        ceLow();
+        setConfig(config_reg & ~NRF_CONFIG_PWR_UP);
+    }
+    
+    // Hot path: payload, CE pulse and STATUS polling with no runtime feature checks
+    bool write(const uint8_t *data, uint8_t len, bool multicast = false)
+    {
+        if (len > NRF_MAX_PAYLOAD_SIZE) return false;
+        if ((config_reg & (NRF_CONFIG_PWR_UP | NRF_CONFIG_PRIM_RX)) != NRF_CONFIG_PWR_UP) {
+            // Only a powered-down chip needs the oscillator start-up; RX to TX is a turnaround
+            bool powered = config_reg & NRF_CONFIG_PWR_UP;
+            ceLow();
+            setConfig((config_reg | NRF_CONFIG_PWR_UP) & ~NRF_CONFIG_PRIM_RX);
+            sleep_us(powered ? NRF24_RX_SETTLE_US : NRF24_POWER_UP_US);
+        }
+        
+        uint8_t cmd = NRF_W_TX_PAYLOAD;
+        if ((FEATURES & NRF24_FEATURE_DYNAMIC_ACK) && multicast) {
+            cmd = NRF_W_TX_PAYLOAD_NO_ACK;
+        }
+        transfer(cmd, data, NULL, len);
+        if (status & (NRF_STATUS_RX_DR | NRF_STATUS_TX_DS | NRF_STATUS_MAX_RT)) {
+            writeReg(NRF_STATUS_REGISTER, NRF_STATUS_RX_DR | NRF_STATUS_TX_DS | NRF_STATUS_MAX_RT);
+        }
+        
+        ceHigh();
+        busy_wait_us_32(15);
+        ceLow();
+        
+        // Wait for transmission to complete, no longer than the retry settings allow
+        uint32_t deadline_us = txDeadlineUs(len, multicast);
+        uint32_t start = time_us_32();
+        while (!(transfer(NRF_NOP, NULL, NULL, 0) & (NRF_STATUS_TX_DS | NRF_STATUS_MAX_RT))) {
+            if (time_us_32() - start > deadline_us) {
+                flushTx();
+                counters.sent(false);
+                return false;
+            }
+        }
+        
+        bool delivered = (status & NRF_STATUS_TX_DS) != 0;
+        writeReg(NRF_STATUS_REGISTER, NRF_STATUS_TX_DS | NRF_STATUS_MAX_RT);
+        if (!delivered) {
+            flushTx();
+        }
+        counters.sent(delivered);
+        return delivered;
+    }
+    
+    bool available(uint8_t *pipe_num = NULL)
+    {
+        if (IRQ != NRF24T_NO_IRQ && gpio_get(IRQ) && (status & NRF_STATUS_RX_P_NO) == NRF_STATUS_RX_P_NO) {
+            return false;  // IRQ line idle and nothing seen queued: skip the SPI transaction
+        }
+        uint8_t pipe = (transfer(NRF_NOP, NULL, NULL, 0) & NRF_STATUS_RX_P_NO) >> 1;
+        if (pipe >= NRF_MAX_PIPES) return false;
+        if (pipe_num) {
+            *pipe_num = pipe;
+        }
+        return true;
+    }
+    
+    uint8_t read(uint8_t *data, uint8_t len)
+    {
+        uint8_t payload_len = payload_size;
+        if (dynamic_payload) {
+            transfer(NRF_R_RX_PL_WID, NULL, &payload_len, 1);
+            if (payload_len > NRF_MAX_PAYLOAD_SIZE) {
+                flushRx();  // Corrupt width: the datasheet says to discard it
+                return 0;
+            }
+        }
+        if (payload_len > len) payload_len = len;
+        
+        transfer(NRF_R_RX_PAYLOAD, NULL, data, payload_len);
+        writeReg(NRF_STATUS_REGISTER, NRF_STATUS_RX_DR);
+        counters.received();
+        return payload_len;
+    }
+    
+    void writeAckPayload(uint8_t pipe, const uint8_t *data, uint8_t len)
+    {
+        static_assert(FEATURES & NRF24_FEATURE_ACK_PAYLOAD, "NRF24T built without NRF24_FEATURE_ACK_PAYLOAD");
+        transfer(NRF_W_ACK_PAYLOAD | (pipe & 0x07), data, NULL, len > NRF_MAX_PAYLOAD_SIZE ? NRF_MAX_PAYLOAD_SIZE : len);
+    }
+    
+    void getStats(NRF24T_Stats *stats)
+    {
+        static_assert(FEATURES & NRF24_FEATURE_STATS, "NRF24T built without NRF24_FEATURE_STATS");
+        *stats = counters.stats;
+    }
+    
+    // FIFOs and status
+    void flushTx() { transfer(NRF_FLUSH_TX, NULL, NULL, 0); }
+    void flushRx() { transfer(NRF_FLUSH_RX, NULL, NULL, 0); }
+    uint8_t getStatus() { return transfer(NRF_NOP, NULL, NULL, 0); }
+    uint8_t getLastStatus() { return status; }
+};
+
+#endif
@@ -0,0 +1,307 @@
+#include "NRF24_Bulk.h"
+#include <string.h>
+
+// Constructor
+NRF24_Bulk::NRF24_Bulk(NRF24 *radio)
+{
+    this->radio = radio;
+    this->window = NRF24_BULK_WINDOW;
+    this->tx_id = 0xFF;  // Seeded from the clock by the first send()
+    this->poll_no = 0;
+    this->rx_pipe = 0;
+    this->rx_buffer = NULL;
+    this->rx_size = 0;
+    this->rx_id = 0xFF;
+    this->rx_total = 0;
+    this->rx_base = 0;
+    this->rx_irq_driven = false;
+    this->rx_state = NRF24_BULK_IDLE;
+    memset(frame_map, 0, sizeof(frame_map));
+    memset(&stats, 0, sizeof(stats));
+}
+
+void NRF24_Bulk::begin()
+{
+    radio->enableDynamicPayloads();
+    radio->enableAckPayload();
+    radio->enableDynamicAck();
+}
+
+void NRF24_Bulk::setWindow(uint16_t frames)
+{
+    if (frames == 0) frames = 1;
+    if (frames > NRF24_BULK_REPORT_BITS) frames = NRF24_BULK_REPORT_BITS;
+    this->window = frames;
+}
+
+// Transmission
+bool NRF24_Bulk::send(const uint8_t *data, uint16_t len)
+{
+    if (len > NRF24_BULK_MAX_SIZE) return false;
+    
+    // A sender that restarts is unlikely to pick the id it used last
+    if (tx_id > 0x0F) {
+        tx_id = radio->getTransport()->micros() & 0x0F;
+    }
+    uint8_t id = tx_id;
+    tx_id = (tx_id + 1) & 0x0F;
+    uint16_t frames = (len + NRF24_BULK_FRAME_DATA - 1) / NRF24_BULK_FRAME_DATA;
+    memset(frame_map, 0, sizeof(frame_map));
+    radio->stopListening();
+    if (!start(id, len)) return false;
+    
+    uint8_t frame[NRF_MAX_PAYLOAD_SIZE];
+    uint8_t bitmap[NRF24_BULK_REPORT_BITS / 8];
+    uint16_t base = 0;
+    uint16_t next_new = 0;
+    uint8_t failures = 0;
+    
+    while (true) {
+        // Every frame of the window the receiver has not confirmed, without ACKs
+        uint16_t end = base + window < frames ? base + window : frames;
+        bool stalled = false;
+        for (uint16_t seq = base; seq < end; seq++) {
+            if (isMarked(seq)) continue;
+            
+            uint16_t offset = seq * NRF24_BULK_FRAME_DATA;
+            uint8_t chunk = len - offset < NRF24_BULK_FRAME_DATA ? len - offset : NRF24_BULK_FRAME_DATA;
+            frame[0] = NRF24_BULK_DATA | id;
+            frame[1] = seq & 0xFF;
+            frame[2] = seq >> 8;
+            memcpy(frame + NRF24_BULK_HEADER_SIZE, data + offset, chunk);
+            if (!radio->writeFast(frame, NRF24_BULK_HEADER_SIZE + chunk, true)) {
+                stalled = true;  // TX FIFO stuck; the rest of the window goes out next round
+                break;
+            }
+            
+            if (seq < next_new) {
+                stats.frames_resent++;
+            } else {
+                stats.frames_sent++;
+                next_new = seq + 1;
+            }
+        }
+        radio->txStandBy(NRF24_BULK_DRAIN_MS);
+        stats.windows++;
+        
+        uint16_t report_base;
+        if (stalled || !poll(id, len, &report_base, bitmap)) {
+            if (++failures >= NRF24_BULK_MAX_POLL_FAILURES) return false;
+            continue;
+        }
+        failures = 0;
+        
+        // Everything below the receiver's base is held, plus what the bitmap marks
+        for (uint16_t seq = base; seq < report_base && seq < frames; seq++) {
+            mark(seq);
+        }
+        for (uint16_t i = 0; i < NRF24_BULK_REPORT_BITS && report_base + i < frames; i++) {
+            if (bitmap[i / 8] & (1 << (i % 8))) {
+                mark(report_base + i);
+            }
+        }
+        if (report_base >= frames) return true;
+        if (report_base > base) {
+            base = report_base;
+        }
+    }
+}
+
+// Announces the transfer. The receiver drops whatever it held, so frames are matched
+// to this transfer even if an earlier one used the same id.
+bool NRF24_Bulk::start(uint8_t id, uint16_t total)
+{
+    uint8_t frame[NRF24_BULK_HEADER_SIZE];
+    frame[0] = NRF24_BULK_START | id;
+    frame[1] = total & 0xFF;
+    frame[2] = total >> 8;
+    
+    NRF24_Packet reply;
+    for (uint8_t attempt = 0; attempt < NRF24_BULK_POLL_TRIES; attempt++) {
+        if (radio->write(frame, NRF24_BULK_HEADER_SIZE)) {
+            // Its ACK carried the receiver's last report, which belongs to the old transfer
+            while (radio->available()) {
+                radio->read(reply.data, NRF_MAX_PAYLOAD_SIZE);
+            }
+            return true;
+        }
+        radio->getTransport()->delayUs(NRF24_BULK_POLL_GAP_US);
+    }
+    return false;
+}
+
+// Asks the receiver for its report. The ACK to a POLL carries whatever report the
+// receiver had loaded before it, so retry until one answers this poll number.
+bool NRF24_Bulk::poll(uint8_t id, uint16_t total, uint16_t *base, uint8_t *bitmap)
+{
+    poll_no++;
+    uint8_t frame[4];
+    frame[0] = NRF24_BULK_POLL | id;
+    frame[1] = poll_no;
+    frame[2] = total & 0xFF;
+    frame[3] = total >> 8;
+    
+    NRF24_Packet reply;
+    for (uint8_t attempt = 0; attempt < NRF24_BULK_POLL_TRIES; attempt++) {
+        stats.polls++;
+        if (radio->write(frame, 4)) {
+            uint8_t pipe;
+            while (radio->available(&pipe)) {
+                reply.length = radio->read(reply.data, NRF_MAX_PAYLOAD_SIZE);
+                if (reply.length == NRF_MAX_PAYLOAD_SIZE && reply.data[0] == (NRF24_BULK_REPORT | id) &&
+                    reply.data[1] == poll_no) {
+                    *base = reply.data[2] | (reply.data[3] << 8);
+                    memcpy(bitmap, reply.data + 4, NRF24_BULK_REPORT_BITS / 8);
+                    stats.reports++;
+                    return true;
+                }
+            }
+        }
+        radio->getTransport()->delayUs(NRF24_BULK_POLL_GAP_US);
+    }
+    return false;
+}
+
+// Reception
+void NRF24_Bulk::startReceive(uint8_t pipe, uint8_t *buffer, uint16_t size)
+{
+    rx_pipe = pipe;
+    rx_buffer = buffer;
+    rx_size = size;
+    rx_id = 0xFF;
+    rx_base = 0;
+    rx_state = NRF24_BULK_IDLE;
+    memset(frame_map, 0, sizeof(frame_map));
+    
+    // Answer polls straight from the IRQ so the sender does not wait on the main loop.
+    // Each sent report raises TX_DS, which would hold the IRQ line low, so mask it.
+    radio->maskInterrupt(NRF_CONFIG_MASK_TX_DS);
+    radio->onEvent(NRF24_EVENT_RX_READY, onReceive, this);
+    rx_irq_driven = radio->enableInterrupts();
+    radio->flushTxFifo();
+    radio->startListening();
+}
+
+void NRF24_Bulk::stopReceive()
+{
+    radio->onEvent(NRF24_EVENT_RX_READY, NULL);
+    rx_irq_driven = false;
+    rx_buffer = NULL;
+    radio->flushTxFifo();
+    radio->unmaskInterrupt(NRF_CONFIG_MASK_TX_DS);
+}
+
+void NRF24_Bulk::onReceive(NRF24 *radio, void *user_data)
+{
+    (void)radio;
+    static_cast<NRF24_Bulk *>(user_data)->service();
+}
+
+NRF24_BulkState NRF24_Bulk::poll()
+{
+    if (!rx_irq_driven) {
+        service();
+    }
+    return rx_state;
+}
+
+uint16_t NRF24_Bulk::getReceivedLength()
+{
+    return rx_state == NRF24_BULK_COMPLETE ? rx_total : 0;
+}
+
+// Move everything the radio holds through the receive state machine
+void NRF24_Bulk::service()
+{
+    NRF24_Packet packet;
+    if (radio->isRxBufferEnabled()) {
+        while (radio->receive(&packet)) {
+            handleFrame(packet.pipe, packet.data, packet.length);
+        }
+    } else {
+        uint8_t pipe;
+        while (radio->available(&pipe)) {
+            uint8_t len = radio->read(packet.data, NRF_MAX_PAYLOAD_SIZE);
+            handleFrame(pipe, packet.data, len);
+        }
+    }
+}
+
+void NRF24_Bulk::handleFrame(uint8_t pipe, const uint8_t *data, uint8_t len)
+{
+    if (!rx_buffer || pipe != rx_pipe || len < NRF24_BULK_HEADER_SIZE) return;
+    
+    uint8_t type = data[0] & 0xF0;
+    uint8_t id = data[0] & 0x0F;
+    
+    // START replaces the previous transfer, complete or not, even if the id repeats
+    if (type == NRF24_BULK_START) {
+        uint16_t total = data[1] | (data[2] << 8);
+        bool fits = total <= rx_size;  // If not, polls go unanswered and the sender gives up
+        rx_id = fits ? id : 0xFF;
+        rx_total = total;
+        rx_base = 0;
+        rx_state = fits ? NRF24_BULK_RECEIVING : NRF24_BULK_IDLE;
+        memset(frame_map, 0, sizeof(frame_map));
+        radio->flushTxFifo();  // The loaded report belongs to the old transfer
+        return;
+    }
+    
+    // Anything else must belong to the announced transfer
+    if (id != rx_id || (type != NRF24_BULK_DATA && type != NRF24_BULK_POLL)) return;
+    
+    if (type == NRF24_BULK_DATA) {
+        uint16_t seq = data[1] | (data[2] << 8);
+        uint32_t offset = (uint32_t)seq * NRF24_BULK_FRAME_DATA;
+        uint8_t chunk = len - NRF24_BULK_HEADER_SIZE;
+        if (seq >= NRF24_BULK_MAX_FRAMES || offset + chunk > rx_size || isMarked(seq)) return;
+        
+        memcpy(rx_buffer + offset, data + NRF24_BULK_HEADER_SIZE, chunk);
+        mark(seq);
+    } else {
+        if (len < 4) return;
+        uint16_t total = data[2] | (data[3] << 8);
+        if (total != rx_total) return;  // Not the length START announced
+    }
+    
+    uint16_t frames = (rx_total + NRF24_BULK_FRAME_DATA - 1) / NRF24_BULK_FRAME_DATA;
+    while (rx_base < frames && isMarked(rx_base)) {
+        rx_base++;
+    }
+    if (rx_base >= frames) {
+        rx_state = NRF24_BULK_COMPLETE;
+    }
+    if (type == NRF24_BULK_POLL) {
+        loadReport(data[1]);
+    }
+}
+
+// Replace any stale report with one for this poll; the next POLL's ACK carries it
+void NRF24_Bulk::loadReport(uint8_t poll_no)
+{
+    uint8_t report[NRF_MAX_PAYLOAD_SIZE];
+    memset(report, 0, sizeof(report));
+    report[0] = NRF24_BULK_REPORT | rx_id;
+    report[1] = poll_no;
+    report[2] = rx_base & 0xFF;
+    report[3] = rx_base >> 8;
+    for (uint16_t i = 0; i < NRF24_BULK_REPORT_BITS && rx_base + i < NRF24_BULK_MAX_FRAMES; i++) {
+        if (isMarked(rx_base + i)) {
+            report[4 + i / 8] |= 1 << (i % 8);
+        }
+    }
+    
+    radio->flushTxFifo();
+    radio->writeAckPayload(rx_pipe, report, sizeof(report));
+    stats.reports++;
+}
+
+void NRF24_Bulk::getStats(NRF24_BulkStats *stats)
+{
+    *stats = this->stats;
+}
+
+void NRF24_Bulk::resetStats()
+{
+    memset(&stats, 0, sizeof(stats));
+}
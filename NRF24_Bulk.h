@@ -0,0 +1,101 @@
+
+#ifndef __NRF24_BULK_H_
+#define __NRF24_BULK_H_
+
+#include "NRF24.h"
+
+// Frame types (high nibble of byte 0; the low nibble is the transfer id)
+#define NRF24_BULK_DATA             0x10  // [type|id][seq:16][data], sent without ACK
+#define NRF24_BULK_POLL             0x20  // [type|id][poll no][total length:16], acknowledged
+#define NRF24_BULK_REPORT           0x30  // [type|id][poll no][base:16][bitmap], as ACK payload
+#define NRF24_BULK_START            0x40  // [type|id][total length:16], acknowledged
+
+#define NRF24_BULK_HEADER_SIZE      3
+#define NRF24_BULK_FRAME_DATA       (NRF_MAX_PAYLOAD_SIZE - NRF24_BULK_HEADER_SIZE)
+#define NRF24_BULK_REPORT_BITS      ((NRF_MAX_PAYLOAD_SIZE - 4) * 8)
+
+// Transfer limits
+#define NRF24_BULK_MAX_SIZE         32768
+#define NRF24_BULK_MAX_FRAMES       ((NRF24_BULK_MAX_SIZE + NRF24_BULK_FRAME_DATA - 1) / NRF24_BULK_FRAME_DATA)
+#define NRF24_BULK_WINDOW           64    // Frames in flight between polls (<= NRF24_BULK_REPORT_BITS)
+
+// Polling: the first POLL of a round usually returns the previous report, because
+// the receiver loads the new one only after seeing it
+#define NRF24_BULK_POLL_TRIES       8
+#define NRF24_BULK_POLL_GAP_US      250
+#define NRF24_BULK_MAX_POLL_FAILURES 8
+
+// Upper bound for a window's frames to leave the TX FIFO (no retries without ACKs)
+#define NRF24_BULK_DRAIN_MS         10
+
+enum NRF24_BulkState {
+    NRF24_BULK_IDLE = 0,
+    NRF24_BULK_RECEIVING = 1,
+    NRF24_BULK_COMPLETE = 2
+};
+
+typedef struct {
+    uint32_t frames_sent;      // First transmissions
+    uint32_t frames_resent;    // Holes filled after a report
+    uint32_t windows;
+    uint32_t polls;            // POLL frames sent, retries included
+    uint32_t reports;          // Fresh reports received (sender) or loaded (receiver)
+} NRF24_BulkStats;
+
+// Bulk transfer with selective repeat. Data frames go out back-to-back without
+// hardware ACKs; after each window the sender polls and the receiver answers with a
+// bitmap of what it holds (as an ACK payload), so only the holes are resent.
+// Both sides need dynamic payloads, ACK payloads and dynamic ACK (see begin()).
+class NRF24_Bulk
+{
+private:
+    NRF24 *radio;
+    uint8_t frame_map[(NRF24_BULK_MAX_FRAMES + 7) / 8];  // Sender: acknowledged, receiver: held
+    NRF24_BulkStats stats;
+    uint16_t window;
+    
+    // Sender
+    uint8_t tx_id;
+    uint8_t poll_no;
+    
+    // Receiver
+    uint8_t rx_pipe;
+    uint8_t *rx_buffer;
+    uint16_t rx_size;
+    uint8_t rx_id;              // 0xFF until a START is accepted
+    uint16_t rx_total;
+    uint16_t rx_base;
+    bool rx_irq_driven;
+    volatile NRF24_BulkState rx_state;
+    
+    bool isMarked(uint16_t seq) { return frame_map[seq / 8] & (1 << (seq % 8)); }
+    void mark(uint16_t seq) { frame_map[seq / 8] |= 1 << (seq % 8); }
+    bool start(uint8_t id, uint16_t total);
+    bool poll(uint8_t id, uint16_t total, uint16_t *base, uint8_t *bitmap);
+    void service();
+    void handleFrame(uint8_t pipe, const uint8_t *data, uint8_t len);
+    void loadReport(uint8_t poll_no);
+    static void onReceive(NRF24 *radio, void *user_data);
+
+public:
+    NRF24_Bulk(NRF24 *radio);
+    
+    // Enable dynamic payloads, ACK payloads and dynamic ACK on the radio
+    void begin();
+    void setWindow(uint16_t frames);
+    
+    // Sender: blocks until the receiver holds every byte, or polls or the TX FIFO keep failing
+    bool send(const uint8_t *data, uint16_t len);
+    
+    // Receiver: listen on an opened pipe. With the IRQ engine available, reports are
+    // answered from the interrupt; otherwise call poll() often.
+    void startReceive(uint8_t pipe, uint8_t *buffer, uint16_t size);
+    void stopReceive();
+    NRF24_BulkState poll();
+    uint16_t getReceivedLength();
+    
+    void getStats(NRF24_BulkStats *stats);
+    void resetStats();
+};
+
+#endif
@@ -0,0 +1,249 @@
+#include "NRF24_Hop.h"
+#include <string.h>
+
+// Constructor
+NRF24_Hopper::NRF24_Hopper(NRF24 *radio)
+{
+    this->radio = radio;
+    this->length = 0;
+    this->blacklist_callback = NULL;
+    this->blacklist_callback_data = NULL;
+    this->dwell_us = NRF24_HOP_DWELL_US;
+    this->slot = 0;
+    this->slot_start_us = 0;
+    this->current_channel = 0;
+    this->missed_hops = 0;
+    this->running = false;
+#if NRF24_PICO
+    this->alarm = 0;
+#endif
+    memset(blacklist, 0, sizeof(blacklist));
+    memset(channel_stats, 0, sizeof(channel_stats));
+}
+
+bool NRF24_Hopper::begin(uint32_t seed, uint32_t dwell_us, uint8_t first, uint8_t last)
+{
+    if (first > last || last > NRF_MAX_CHANNEL || dwell_us == 0) return false;
+    stop();
+    
+    this->dwell_us = dwell_us;
+    this->length = last - first + 1;
+    for (uint8_t i = 0; i < length; i++) {
+        sequence[i] = first + i;
+    }
+    
+    // Fisher-Yates shuffle driven by xorshift32, identical on every node
+    uint32_t state = seed ? seed : 1;
+    for (uint8_t i = length - 1; i > 0; i--) {
+        state ^= state << 13;
+        state ^= state >> 17;
+        state ^= state << 5;
+        uint8_t j = state % (i + 1);
+        uint8_t channel = sequence[i];
+        sequence[i] = sequence[j];
+        sequence[j] = channel;
+    }
+    
+    memset(blacklist, 0, sizeof(blacklist));
+    memset(channel_stats, 0, sizeof(channel_stats));
+    buildHopTable();
+    return true;
+}
+
+// Each slot's channel, so a hop is a single RF_CH write
+void NRF24_Hopper::buildHopTable()
+{
+    for (uint8_t i = 0; i < length; i++) {
+        uint8_t k = 0;
+        while (k < length && isListed(sequence[(i + k) % length])) {
+            k++;
+        }
+        hop_table[i] = k < length ? sequence[(i + k) % length] : sequence[i];
+    }
+}
+
+bool NRF24_Hopper::start(uint32_t epoch_us)
+{
+    if (!length) return false;
+    stop();
+    
+    slot = 0;
+    slot_start_us = epoch_us;
+    missed_hops = 0;
+    current_channel = hop_table[0];
+    radio->setChannel(current_channel);
+    running = true;
+    
+#if NRF24_PICO
+    alarm = add_alarm_in_us(timeToHop() + 1, onAlarm, this, true);
+#endif
+    return true;
+}
+
+void NRF24_Hopper::stop()
+{
+    running = false;
+#if NRF24_PICO
+    if (alarm > 0) {
+        cancel_alarm(alarm);
+        alarm = 0;
+    }
+#endif
+}
+
+#if NRF24_PICO
+int64_t NRF24_Hopper::onAlarm(alarm_id_t id, void *user_data)
+{
+    (void)id;
+    NRF24_Hopper *hopper = static_cast<NRF24_Hopper *>(user_data);
+    if (!hopper->running) return 0;
+    
+    // Rescheduled relative to now, so a late alarm lands on the next boundary
+    return hopper->hop() + 1;
+}
+#endif
+
+// Move to the slot the clock is in. Returns the time left in that slot.
+uint32_t NRF24_Hopper::hop()
+{
+    uint32_t elapsed = radio->getTransport()->micros() - slot_start_us;
+    if ((int32_t)elapsed < 0) return -(int32_t)elapsed;  // Before the epoch
+    
+    if (elapsed >= dwell_us) {
+        uint32_t steps = elapsed / dwell_us;
+        missed_hops += steps - 1;
+        slot += steps;
+        slot_start_us += steps * dwell_us;
+        elapsed -= steps * dwell_us;
+        current_channel = hop_table[slot % length];
+        radio->hopToChannel(current_channel);
+    }
+    return dwell_us - elapsed;
+}
+
+// Hops without a timer alarm (host builds, or no alarm slot left)
+void NRF24_Hopper::update()
+{
+#if NRF24_PICO
+    if (alarm > 0) return;
+#endif
+    if (running) {
+        hop();
+    }
+}
+
+void NRF24_Hopper::getSyncInfo(uint32_t *slot, uint32_t *offset_us)
+{
+    uint32_t now = radio->getTransport()->micros();
+    uint32_t s, start;
+    do {
+        s = this->slot;
+        start = slot_start_us;
+    } while (s != this->slot);
+    
+    // A hop that is due but not yet taken still counts
+    uint32_t offset = now - start;
+    if ((int32_t)offset < 0) offset = 0;
+    s += offset / dwell_us;
+    *slot = s;
+    *offset_us = offset % dwell_us;
+}
+
+void NRF24_Hopper::resync(uint32_t slot, uint32_t offset_us)
+{
+    if (!length) return;
+#if NRF24_PICO
+    if (alarm > 0) {
+        cancel_alarm(alarm);
+        alarm = 0;
+    }
+#endif
+    
+    slot += offset_us / dwell_us;
+    offset_us %= dwell_us;
+    this->slot = slot;
+    slot_start_us = radio->getTransport()->micros() - offset_us;
+    current_channel = hop_table[slot % length];
+    radio->hopToChannel(current_channel);
+    running = true;
+    
+#if NRF24_PICO
+    alarm = add_alarm_in_us(timeToHop() + 1, onAlarm, this, true);
+#endif
+}
+
+uint32_t NRF24_Hopper::timeToHop()
+{
+    uint32_t elapsed = radio->getTransport()->micros() - slot_start_us;
+    if ((int32_t)elapsed < 0) return -(int32_t)elapsed;
+    return elapsed >= dwell_us ? 0 : dwell_us - elapsed;
+}
+
+// Loss accounting
+void NRF24_Hopper::record(bool delivered)
+{
+    uint8_t channel = current_channel;
+    NRF24_HopChannelStats *stats = &channel_stats[channel];
+    stats->sent++;
+    if (!delivered) {
+        stats->lost++;
+    }
+    if (stats->sent >= NRF24_HOP_AGE_SAMPLES) {
+        stats->sent /= 2;
+        stats->lost /= 2;
+    }
+    
+    if (!blacklist_callback || isListed(channel) || stats->sent < NRF24_HOP_MIN_SAMPLES) return;
+    if ((uint32_t)stats->lost * 100 < (uint32_t)stats->sent * NRF24_HOP_BLACKLIST_LOSS) return;
+    
+    uint8_t active = 0;
+    for (uint8_t i = 0; i < length; i++) {
+        if (!isListed(sequence[i])) active++;
+    }
+    if (active > NRF24_HOP_MIN_ACTIVE && blacklist_callback(this, channel, blacklist_callback_data)) {
+        setBlacklisted(channel, true);
+    }
+}
+
+void NRF24_Hopper::getChannelStats(uint8_t channel, NRF24_HopChannelStats *stats)
+{
+    if (channel > NRF_MAX_CHANNEL) return;
+    *stats = channel_stats[channel];
+}
+
+// Automatic blacklisting only happens with a callback, since the peer has to follow
+void NRF24_Hopper::onBlacklist(NRF24_HopBlacklistCallback callback, void *user_data)
+{
+    this->blacklist_callback = callback;
+    this->blacklist_callback_data = user_data;
+}
+
+// Blacklist
+void NRF24_Hopper::setBlacklisted(uint8_t channel, bool listed)
+{
+    if (channel > NRF_MAX_CHANNEL) return;
+    
+    if (listed) {
+        blacklist[channel / 8] |= 1 << (channel % 8);
+    } else {
+        blacklist[channel / 8] &= ~(1 << (channel % 8));
+        memset(&channel_stats[channel], 0, sizeof(NRF24_HopChannelStats));
+    }
+    buildHopTable();
+}
+
+bool NRF24_Hopper::isBlacklisted(uint8_t channel)
+{
+    return channel <= NRF_MAX_CHANNEL && isListed(channel);
+}
+
+void NRF24_Hopper::getBlacklist(uint8_t *map)
+{
+    memcpy(map, blacklist, sizeof(blacklist));
+}
+
+void NRF24_Hopper::setBlacklist(const uint8_t *map)
+{
+    memcpy(blacklist, map, sizeof(blacklist));
+    buildHopTable();
+}
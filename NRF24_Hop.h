@@ -0,0 +1,93 @@
+
+#ifndef __NRF24_HOP_H_
+#define __NRF24_HOP_H_
+
+#include "NRF24.h"
+
+// Hop sequence limits
+#define NRF24_HOP_MAX_CHANNELS      (NRF_MAX_CHANNEL + 1)
+#define NRF24_HOP_MIN_ACTIVE        4     // Automatic blacklisting stops here
+#define NRF24_HOP_DWELL_US          10000
+
+// Automatic blacklisting: a channel that lost this share of at least MIN_SAMPLES packets.
+// Counters halve at AGE_SAMPLES so old history fades.
+#define NRF24_HOP_MIN_SAMPLES       32
+#define NRF24_HOP_BLACKLIST_LOSS    50    // Percent
+#define NRF24_HOP_AGE_SAMPLES       256
+
+typedef struct {
+    uint16_t sent;
+    uint16_t lost;
+} NRF24_HopChannelStats;
+
+class NRF24_Hopper;
+
+// Called before a channel is blacklisted automatically; the peer must apply the same
+// blacklist (see getBlacklist()/setBlacklist()). Return false to veto.
+typedef bool (*NRF24_HopBlacklistCallback)(NRF24_Hopper *hopper, uint8_t channel, void *user_data);
+
+// Frequency hopping on a pseudo-random channel sequence derived from a shared seed.
+// Slot n starts at epoch + n * dwell; each slot maps to a precomputed channel, with
+// blacklisted channels replaced by the next usable entry of the sequence. On the Pico
+// a timer alarm writes RF_CH at every slot boundary; elsewhere, call update() often.
+// Hops are derived from the clock, so a late or missed hop catches up to the right slot.
+class NRF24_Hopper
+{
+private:
+    NRF24 *radio;
+    uint8_t sequence[NRF24_HOP_MAX_CHANNELS];
+    uint8_t hop_table[NRF24_HOP_MAX_CHANNELS];   // Sequence with blacklisted entries replaced
+    uint8_t length;
+    uint8_t blacklist[(NRF24_HOP_MAX_CHANNELS + 7) / 8];
+    NRF24_HopChannelStats channel_stats[NRF24_HOP_MAX_CHANNELS];
+    NRF24_HopBlacklistCallback blacklist_callback;
+    void *blacklist_callback_data;
+    
+    uint32_t dwell_us;
+    volatile uint32_t slot;
+    volatile uint32_t slot_start_us;
+    volatile uint8_t current_channel;
+    volatile uint32_t missed_hops;
+    volatile bool running;
+#if NRF24_PICO
+    alarm_id_t alarm;
+    static int64_t onAlarm(alarm_id_t id, void *user_data);
+#endif
+
+    bool isListed(uint8_t channel) { return blacklist[channel / 8] & (1 << (channel % 8)); }
+    void buildHopTable();
+    uint32_t hop();
+
+public:
+    NRF24_Hopper(NRF24 *radio);
+    
+    // Channels first..last in an order derived from seed; both ends use the same values
+    bool begin(uint32_t seed, uint32_t dwell_us = NRF24_HOP_DWELL_US, uint8_t first = 2, uint8_t last = 80);
+    
+    // Slot 0 starts at epoch_us on the transport clock
+    bool start(uint32_t epoch_us);
+    void stop();
+    bool isRunning() { return running; }
+    void update();
+    
+    // Synchronization: a peer reports the slot it is in and how far into it it is
+    void getSyncInfo(uint32_t *slot, uint32_t *offset_us);
+    void resync(uint32_t slot, uint32_t offset_us);
+    uint32_t getSlot() { return slot; }
+    uint8_t getCurrentChannel() { return current_channel; }
+    uint32_t timeToHop();
+    uint32_t getMissedHops() { return missed_hops; }
+    
+    // Loss accounting for the current channel (call after each write())
+    void record(bool delivered);
+    void getChannelStats(uint8_t channel, NRF24_HopChannelStats *stats);
+    void onBlacklist(NRF24_HopBlacklistCallback callback, void *user_data = NULL);
+    
+    // Blacklist, as a bitmap indexed by channel number
+    void setBlacklisted(uint8_t channel, bool listed);
+    bool isBlacklisted(uint8_t channel);
+    void getBlacklist(uint8_t *map);
+    void setBlacklist(const uint8_t *map);
+};
+
+#endif
@@ -0,0 +1,183 @@
+#include "NRF24_Link.h"
+#include <string.h>
+
+// Constructor
+NRF24_LinkControl::NRF24_LinkControl(NRF24 *radio)
+{
+    this->radio = radio;
+    this->rate_callback = NULL;
+    this->rate_callback_data = NULL;
+    this->user_delay = radio->getRetryDelay();
+    this->bounds.min_power = NRF24_POWER_LEVEL_NEG18DBM;
+    this->bounds.max_power = NRF24_POWER_LEVEL_0DBM;
+    this->bounds.slowest_rate = NRF24_DATA_RATE_250KBPS;
+    this->bounds.fastest_rate = NRF24_DATA_RATE_2MBPS;
+    this->bounds.min_retries = 1;
+    this->bounds.max_retries = 15;
+    this->backoff = 0;
+    this->hold = 0;
+    this->climbed = false;
+    resetStats();
+}
+
+void NRF24_LinkControl::setBounds(const NRF24_LinkBounds *bounds)
+{
+    this->bounds = *bounds;
+    this->user_delay = radio->getRetryDelay();
+    
+    NRF24_PowerLevel power = radio->getPowerLevel();
+    if (power < bounds->min_power) radio->setPowerLevel(bounds->min_power);
+    if (power > bounds->max_power) radio->setPowerLevel(bounds->max_power);
+    
+    uint8_t rank = rateRank(radio->getDataRate());
+    if (rank < rateRank(bounds->slowest_rate)) radio->setDataRate(bounds->slowest_rate);
+    if (rank > rateRank(bounds->fastest_rate)) radio->setDataRate(bounds->fastest_rate);
+    
+    uint8_t retries = radio->getRetryCount();
+    if (retries < bounds->min_retries) radio->setRetryCount(bounds->min_retries);
+    if (retries > bounds->max_retries) radio->setRetryCount(bounds->max_retries);
+    settle();
+}
+
+// Data rate changes only happen with a callback, since the receiver has to follow
+void NRF24_LinkControl::onRateChange(NRF24_LinkRateCallback callback, void *user_data)
+{
+    this->rate_callback = callback;
+    this->rate_callback_data = user_data;
+}
+
+bool NRF24_LinkControl::write(uint8_t *data, uint8_t len)
+{
+    bool delivered = radio->write(data, len);
+    update(delivered);
+    return delivered;
+}
+
+void NRF24_LinkControl::update(bool delivered)
+{
+    // ARC_CNT holds this packet's retransmits (the full count after MAX_RT)
+    int32_t retransmits = (int32_t)radio->getRetransmitCount() << 8;
+    int32_t loss = delivered ? 0 : 256;
+    stats.retransmit_avg += (retransmits - (int32_t)stats.retransmit_avg) >> NRF24_LINK_SHIFT;
+    stats.loss_avg += (loss - (int32_t)stats.loss_avg) >> NRF24_LINK_SHIFT;
+    stats.packets++;
+    if (!delivered) {
+        stats.failures++;
+    }
+    
+    if (++window_count < NRF24_LINK_WINDOW) return;
+    window_count = 0;
+    
+    if (stats.loss_avg > NRF24_LINK_LOSS_HIGH || stats.retransmit_avg > NRF24_LINK_RETX_HIGH) {
+        // A climb that made things worse: back off before trying it again
+        if (climbed) {
+            backoff = backoff ? backoff * 2 : 1;
+            if (backoff > NRF24_LINK_MAX_BACKOFF) backoff = NRF24_LINK_MAX_BACKOFF;
+            climbed = false;
+        }
+        hold = backoff;
+        if (stepDown()) {
+            stats.steps_down++;
+            settle();
+        }
+    } else if (stats.loss_avg < NRF24_LINK_LOSS_LOW && stats.retransmit_avg < NRF24_LINK_RETX_LOW) {
+        if (climbed) {
+            backoff = 0;
+            climbed = false;
+        }
+        if (hold) {
+            hold--;
+        } else if (stepUp()) {
+            stats.steps_up++;
+            climbed = true;
+            settle();
+        }
+    }
+}
+
+// Ordered from most robust to fastest
+uint8_t NRF24_LinkControl::rateRank(NRF24_DataRate rate)
+{
+    switch (rate) {
+        case NRF24_DATA_RATE_250KBPS: return 0;
+        case NRF24_DATA_RATE_1MBPS: return 1;
+        default: return 2;
+    }
+}
+
+bool NRF24_LinkControl::changeRate(int8_t direction)
+{
+    static const NRF24_DataRate by_rank[] = {
+        NRF24_DATA_RATE_250KBPS, NRF24_DATA_RATE_1MBPS, NRF24_DATA_RATE_2MBPS
+    };
+    
+    if (!rate_callback) return false;
+    int8_t rank = rateRank(radio->getDataRate()) + direction;
+    if (rank < rateRank(bounds.slowest_rate) || rank > rateRank(bounds.fastest_rate)) return false;
+    
+    NRF24_DataRate rate = by_rank[rank];
+    if (!rate_callback(radio, rate, rate_callback_data)) return false;
+    
+    radio->setDataRate(rate);
+    if (rate == NRF24_DATA_RATE_250KBPS && user_delay < NRF24_LINK_ARD_250KBPS) {
+        radio->setRetryDelay(NRF24_LINK_ARD_250KBPS);
+    } else {
+        radio->setRetryDelay(user_delay);
+    }
+    return true;
+}
+
+// More power, then a slower rate, then more retries
+bool NRF24_LinkControl::stepDown()
+{
+    NRF24_PowerLevel power = radio->getPowerLevel();
+    if (power < bounds.max_power) {
+        radio->setPowerLevel((NRF24_PowerLevel)(power + 1));
+        return true;
+    }
+    if (changeRate(-1)) return true;
+    
+    uint8_t retries = radio->getRetryCount();
+    if (retries < bounds.max_retries) {
+        radio->setRetryCount(retries + 1);
+        return true;
+    }
+    return false;
+}
+
+// A faster rate, then fewer retries, then less power
+bool NRF24_LinkControl::stepUp()
+{
+    if (changeRate(1)) return true;
+    
+    uint8_t retries = radio->getRetryCount();
+    if (retries > bounds.min_retries) {
+        radio->setRetryCount(retries - 1);
+        return true;
+    }
+    NRF24_PowerLevel power = radio->getPowerLevel();
+    if (power > bounds.min_power) {
+        radio->setPowerLevel((NRF24_PowerLevel)(power - 1));
+        return true;
+    }
+    return false;
+}
+
+// Start the averages between the thresholds so the next decision rests on new samples
+void NRF24_LinkControl::settle()
+{
+    stats.retransmit_avg = (NRF24_LINK_RETX_HIGH + NRF24_LINK_RETX_LOW) / 2;
+    stats.loss_avg = (NRF24_LINK_LOSS_HIGH + NRF24_LINK_LOSS_LOW) / 2;
+    window_count = 0;
+}
+
+void NRF24_LinkControl::getStats(NRF24_LinkStats *stats)
+{
+    *stats = this->stats;
+}
+
+void NRF24_LinkControl::resetStats()
+{
+    memset(&stats, 0, sizeof(stats));
+    settle();
+}
@@ -0,0 +1,83 @@
+
+#ifndef __NRF24_LINK_H_
+#define __NRF24_LINK_H_
+
+#include "NRF24.h"
+
+// Smoothing: each packet moves the averages 1/2^NRF24_LINK_SHIFT of the way
+#define NRF24_LINK_SHIFT            3
+#define NRF24_LINK_WINDOW           16    // Packets between decisions
+
+// Thresholds, as 1/256 fractions (loss) and retransmits per packet x 256
+#define NRF24_LINK_LOSS_HIGH        26    // ~10% of packets hit MAX_RT
+#define NRF24_LINK_LOSS_LOW         3     // ~1%
+#define NRF24_LINK_RETX_HIGH        384   // 1.5 retransmits per packet
+#define NRF24_LINK_RETX_LOW         64    // 0.25
+
+// A climb that had to be undone waits this many windows longer each time, up to the cap
+#define NRF24_LINK_MAX_BACKOFF      64
+
+// At 250 kbps an ACK (with payload) needs a longer retransmit delay
+#define NRF24_LINK_ARD_250KBPS      NRF24_ARD_1500US
+
+typedef struct {
+    NRF24_PowerLevel min_power;
+    NRF24_PowerLevel max_power;
+    NRF24_DataRate slowest_rate;
+    NRF24_DataRate fastest_rate;
+    uint8_t min_retries;
+    uint8_t max_retries;
+} NRF24_LinkBounds;
+
+typedef struct {
+    uint32_t packets;
+    uint32_t failures;          // MAX_RT
+    uint16_t retransmit_avg;    // Smoothed retransmits per packet x 256
+    uint16_t loss_avg;          // Smoothed MAX_RT fraction x 256
+    uint32_t steps_up;          // Faster, less power or fewer retries
+    uint32_t steps_down;        // More power, slower or more retries
+} NRF24_LinkStats;
+
+// Called before a data rate change; the receiver must switch too. Return false to veto.
+typedef bool (*NRF24_LinkRateCallback)(NRF24 *radio, NRF24_DataRate rate, void *user_data);
+
+// Optional transmit-side controller. Feed it every write() outcome; it reads ARC from
+// OBSERVE_TX and steps power, data rate and retries within the bounds:
+// a bad link gets more power, then a slower rate, then more retries; a clean one
+// gets a faster rate, then fewer retries, then less power.
+class NRF24_LinkControl
+{
+private:
+    NRF24 *radio;
+    NRF24_LinkBounds bounds;
+    NRF24_LinkStats stats;
+    NRF24_LinkRateCallback rate_callback;
+    void *rate_callback_data;
+    NRF24_AutoRetransmitDelay user_delay;
+    uint8_t window_count;
+    uint8_t backoff;            // Windows to wait before the next climb
+    uint8_t hold;
+    bool climbed;               // The last step was a climb, still on probation
+    
+    static uint8_t rateRank(NRF24_DataRate rate);
+    bool changeRate(int8_t direction);
+    bool stepDown();
+    bool stepUp();
+    void settle();
+
+public:
+    NRF24_LinkControl(NRF24 *radio);
+    
+    // Also applies the bounds to the current configuration
+    void setBounds(const NRF24_LinkBounds *bounds);
+    void onRateChange(NRF24_LinkRateCallback callback, void *user_data = NULL);
+    
+    // Record the outcome of the packet just sent (call right after write())
+    void update(bool delivered);
+    bool write(uint8_t *data, uint8_t len);
+    
+    void getStats(NRF24_LinkStats *stats);
+    void resetStats();
+};
+
+#endif
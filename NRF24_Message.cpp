@@ -0,0 +1,214 @@
+#include "NRF24_Message.h"
+#include <string.h>
+
+// Byte offset of a fragment's data within the message
+static uint32_t fragmentOffset(uint16_t index)
+{
+    return index == 0 ? 0 : NRF24_MESSAGE_FIRST_DATA + (uint32_t)(index - 1) * NRF24_MESSAGE_FRAG_DATA;
+}
+
+// Constructor
+NRF24_Message::NRF24_Message(NRF24 *radio)
+{
+    this->radio = radio;
+    this->tx_id = 0;
+    this->timeout_ms = NRF24_MESSAGE_TIMEOUT_MS;
+    memset(rx, 0, sizeof(rx));
+    memset(&stats, 0, sizeof(stats));
+}
+
+bool NRF24_Message::attachBuffer(uint8_t pipe, uint8_t *buffer, uint16_t size)
+{
+    if (pipe >= NRF_MAX_PIPES) return false;
+    
+    memset(&rx[pipe], 0, sizeof(Reassembly));
+    rx[pipe].buffer = buffer;
+    rx[pipe].capacity = size;
+    return true;
+}
+
+void NRF24_Message::setTimeout(uint32_t timeout_ms)
+{
+    this->timeout_ms = timeout_ms;
+}
+
+// Transmission
+bool NRF24_Message::send(const uint8_t *data, uint16_t len, bool multicast)
+{
+    if (len > NRF24_MESSAGE_MAX_SIZE) return false;
+    
+    bool dynamic = radio->isDynamicPayloadEnabled();
+    uint8_t id = tx_id;
+    tx_id = (tx_id + 1) & 0x0F;
+    
+    uint8_t frame[NRF_MAX_PAYLOAD_SIZE];
+    uint32_t offset = 0;
+    uint16_t index = 0;
+    do {
+        memset(frame, 0, sizeof(frame));
+        frame[0] = (id << 4) | (index >> 8);
+        frame[1] = index & 0xFF;
+        
+        uint8_t header = NRF24_MESSAGE_HEADER_SIZE;
+        uint8_t room = NRF24_MESSAGE_FRAG_DATA;
+        if (index == 0) {
+            frame[2] = len & 0xFF;
+            frame[3] = len >> 8;
+            header += 2;
+            room = NRF24_MESSAGE_FIRST_DATA;
+        }
+        
+        uint32_t chunk = len - offset;
+        if (chunk > room) chunk = room;
+        memcpy(frame + header, data + offset, chunk);
+        
+        // Back-to-back through the TX FIFO with CE held high
+        if (!radio->writeFast(frame, dynamic ? header + chunk : NRF_MAX_PAYLOAD_SIZE, multicast)) {
+            radio->txStandBy(NRF24_MESSAGE_DRAIN_MS);
+            stats.messages_failed++;
+            return false;
+        }
+        offset += chunk;
+        index++;
+    } while (offset < len);
+    
+    bool delivered = radio->txStandBy(NRF24_MESSAGE_DRAIN_MS);
+    if (delivered) {
+        stats.messages_sent++;
+    } else {
+        stats.messages_failed++;
+    }
+    return delivered;
+}
+
+// Reception
+void NRF24_Message::process(uint8_t pipe, const uint8_t *data, uint8_t len)
+{
+    if (pipe >= NRF_MAX_PIPES || len < NRF24_MESSAGE_HEADER_SIZE) return;
+    
+    Reassembly *slot = &rx[pipe];
+    uint8_t id = data[0] >> 4;
+    uint16_t index = ((data[0] & 0x0F) << 8) | data[1];
+    if (!slot->buffer || slot->complete || index >= NRF24_MESSAGE_MAX_FRAGMENTS) {
+        stats.fragments_dropped++;
+        return;
+    }
+    
+    uint8_t header = NRF24_MESSAGE_HEADER_SIZE;
+    if (index == 0) {
+        if (len < NRF24_MESSAGE_HEADER_SIZE + 2) return;
+        uint16_t total = data[2] | (data[3] << 8);
+        header += 2;
+        
+        // A repeated first fragment must not restart the message it belongs to
+        if (!(slot->active && slot->id == id && slot->total == total && (slot->fragments[0] & 0x01))) {
+            if (total > slot->capacity || total > NRF24_MESSAGE_MAX_SIZE) {
+                slot->active = false;
+                stats.fragments_dropped++;
+                return;
+            }
+            slot->active = true;
+            slot->id = id;
+            slot->total = total;
+            slot->received = 0;
+            memset(slot->fragments, 0, sizeof(slot->fragments));
+        }
+    } else if (!slot->active || slot->id != id) {
+        // Its first fragment never arrived
+        stats.fragments_dropped++;
+        return;
+    }
+    
+    uint32_t offset = fragmentOffset(index);
+    if (offset > slot->total) {
+        stats.fragments_dropped++;
+        return;
+    }
+    uint32_t chunk = len - header;
+    if (chunk > slot->total - offset) chunk = slot->total - offset;
+    
+    // The timeout counts from the last fragment, so long messages at slow rates survive
+    slot->last_us = radio->getTransport()->micros();
+    
+    if (!(slot->fragments[index / 8] & (1 << (index % 8)))) {
+        slot->fragments[index / 8] |= 1 << (index % 8);
+        memcpy(slot->buffer + offset, data + header, chunk);
+        slot->received += chunk;
+    }
+    if (slot->received == slot->total) {
+        slot->complete = true;
+        stats.messages_received++;
+    }
+}
+
+// Move everything the radio holds into the reassembly buffers
+void NRF24_Message::update()
+{
+    NRF24_Packet packet;
+    if (radio->isRxBufferEnabled()) {
+        while (radio->receive(&packet)) {
+            process(packet.pipe, packet.data, packet.length);
+        }
+    } else {
+        uint8_t pipe;
+        while (radio->available(&pipe)) {
+            uint8_t len = radio->read(packet.data, NRF_MAX_PAYLOAD_SIZE);
+            process(pipe, packet.data, len);
+        }
+    }
+}
+
+void NRF24_Message::expire()
+{
+    uint32_t now = radio->getTransport()->micros();
+    for (uint8_t i = 0; i < NRF_MAX_PIPES; i++) {
+        Reassembly *slot = &rx[i];
+        if (slot->active && !slot->complete && (now - slot->last_us) / 1000 >= timeout_ms) {
+            slot->active = false;
+            stats.messages_timed_out++;
+        }
+    }
+}
+
+bool NRF24_Message::available(uint8_t *pipe_num)
+{
+    update();
+    expire();
+    
+    for (uint8_t i = 0; i < NRF_MAX_PIPES; i++) {
+        if (rx[i].complete) {
+            if (pipe_num) {
+                *pipe_num = i;
+            }
+            return true;
+        }
+    }
+    return false;
+}
+
+// Copy out the oldest-pipe completed message and free its buffer. Returns its full
+// length, which may exceed len if the caller's buffer was too small.
+uint16_t NRF24_Message::read(uint8_t *data, uint16_t len, uint8_t *pipe_num)
+{
+    uint8_t pipe;
+    if (!available(&pipe)) return 0;
+    
+    Reassembly *slot = &rx[pipe];
+    memcpy(data, slot->buffer, slot->total < len ? slot->total : len);
+    if (pipe_num) {
+        *pipe_num = pipe;
+    }
+    slot->complete = false;
+    slot->active = false;
+    return slot->total;
+}
+
+void NRF24_Message::getStats(NRF24_MessageStats *stats)
+{
+    *stats = this->stats;
+}
+
+void NRF24_Message::resetStats()
+{
+    memset(&stats, 0, sizeof(stats));
+}
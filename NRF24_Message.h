@@ -0,0 +1,83 @@
+
+#ifndef __NRF24_MESSAGE_H_
+#define __NRF24_MESSAGE_H_
+
+#include "NRF24.h"
+
+// Fragment layout: 2-byte header [msg id:4 | index:12], the first fragment also
+// carries the total message length (little endian) before its data
+#define NRF24_MESSAGE_HEADER_SIZE   2
+#define NRF24_MESSAGE_FIRST_DATA    (NRF_MAX_PAYLOAD_SIZE - NRF24_MESSAGE_HEADER_SIZE - 2)
+#define NRF24_MESSAGE_FRAG_DATA     (NRF_MAX_PAYLOAD_SIZE - NRF24_MESSAGE_HEADER_SIZE)
+
+// Largest message, and the fragment bitmap that size needs per pipe
+#define NRF24_MESSAGE_MAX_SIZE      8192
+#define NRF24_MESSAGE_MAX_FRAGMENTS (1 + (NRF24_MESSAGE_MAX_SIZE - NRF24_MESSAGE_FIRST_DATA + \
+                                          NRF24_MESSAGE_FRAG_DATA - 1) / NRF24_MESSAGE_FRAG_DATA)
+
+// Incomplete messages are dropped after this long without a new fragment
+#define NRF24_MESSAGE_TIMEOUT_MS    100
+
+// Upper bound for the TX FIFO to drain at the end of send(), retries included
+#define NRF24_MESSAGE_DRAIN_MS      250
+
+typedef struct {
+    uint32_t messages_sent;
+    uint32_t messages_failed;     // A fragment was not acknowledged
+    uint32_t messages_received;
+    uint32_t messages_timed_out;
+    uint32_t fragments_dropped;   // No buffer, unknown message, or previous message unread
+} NRF24_MessageStats;
+
+// Sends messages larger than one payload as numbered fragments, streamed through
+// the TX FIFO, and reassembles them per pipe into caller-provided buffers.
+// Fragments are full 32-byte payloads (the last one may be shorter with dynamic
+// payloads), so static payload mode needs a payload size of 32.
+class NRF24_Message
+{
+private:
+    // Reassembly state for one pipe
+    typedef struct {
+        uint8_t *buffer;
+        uint16_t capacity;
+        uint16_t total;
+        uint16_t received;
+        uint8_t id;
+        bool active;
+        bool complete;
+        uint32_t last_us;           // Last accepted fragment
+        uint8_t fragments[(NRF24_MESSAGE_MAX_FRAGMENTS + 7) / 8];
+    } Reassembly;
+    
+    NRF24 *radio;
+    Reassembly rx[NRF_MAX_PIPES];
+    uint8_t tx_id;
+    uint32_t timeout_ms;
+    NRF24_MessageStats stats;
+    
+    void update();
+    void expire();
+
+public:
+    NRF24_Message(NRF24 *radio);
+    
+    // Receive side: one reassembly buffer per pipe, sized for the largest message
+    bool attachBuffer(uint8_t pipe, uint8_t *buffer, uint16_t size);
+    void setTimeout(uint32_t timeout_ms);
+    
+    // Send a message of up to NRF24_MESSAGE_MAX_SIZE bytes. Returns true if every
+    // fragment was acknowledged (always true for multicast once queued).
+    bool send(const uint8_t *data, uint16_t len, bool multicast = false);
+    
+    // Polls the radio (or its RX ring) and reports a completed message
+    bool available(uint8_t *pipe_num = NULL);
+    uint16_t read(uint8_t *data, uint16_t len, uint8_t *pipe_num = NULL);
+    
+    // Feed one received payload, e.g. from NRF24_RadioCore::read()
+    void process(uint8_t pipe, const uint8_t *data, uint8_t len);
+    
+    void getStats(NRF24_MessageStats *stats);
+    void resetStats();
+};
+
+#endif
@@ -0,0 +1,346 @@
+#include "NRF24_PicoTransport.h"
+#include "hardware/spi.h"
+#include "hardware/gpio.h"
+#include "hardware/irq.h"
+#include "hardware/dma.h"
+#include "hardware/sync.h"
+#include <string.h>
+
+// Transports with the IRQ line attached, serviced by one shared GPIO handler
+static NRF24_PicoTransport *irq_instances[NRF24_MAX_IRQ_INSTANCES];
+static uint16_t irq_instance_pins[NRF24_MAX_IRQ_INSTANCES];
+static bool irq_handler_installed = false;
+
+static void nrf24GpioIrqHandler()
+{
+    for (int i = 0; i < NRF24_MAX_IRQ_INSTANCES; i++) {
+        if (irq_instances[i] && (gpio_get_irq_event_mask(irq_instance_pins[i]) & GPIO_IRQ_EDGE_FALL)) {
+            gpio_acknowledge_irq(irq_instance_pins[i], GPIO_IRQ_EDGE_FALL);
+            irq_instances[i]->handleGpioIrq();
+        }
+    }
+}
+
+// Transports with DMA enabled, serviced by one shared handler per DMA IRQ line.
+// Each transport raises the line of the core that enabled DMA (DMA_IRQ_0 + core).
+static NRF24_PicoTransport *dma_instances[NRF24_MAX_IRQ_INSTANCES];
+static int dma_instance_chans[NRF24_MAX_IRQ_INSTANCES];
+static uint8_t dma_instance_lines[NRF24_MAX_IRQ_INSTANCES];
+static bool dma_handler_installed[NUM_CORES];
+
+static void nrf24DmaIrqDispatch(uint line)
+{
+    for (int i = 0; i < NRF24_MAX_IRQ_INSTANCES; i++) {
+        if (dma_instances[i] && dma_instance_lines[i] == line &&
+            dma_irqn_get_channel_status(line, dma_instance_chans[i])) {
+            dma_irqn_acknowledge_channel(line, dma_instance_chans[i]);
+            dma_instances[i]->handleDMAComplete();
+        }
+    }
+}
+
+static void nrf24DmaIrq0Handler() { nrf24DmaIrqDispatch(0); }
+static void nrf24DmaIrq1Handler() { nrf24DmaIrqDispatch(1); }
+
+// Constructors
+NRF24_PicoTransport::NRF24_PicoTransport()
+{
+    this->spi = NULL;
+    this->sck = 0xFF;
+    this->mosi = 0xFF;
+    this->miso = 0xFF;
+    this->csn = 0xFF;
+    this->ce = 0xFF;
+    this->irq = 0xFF;
+    this->irq_handler = NULL;
+    this->irq_context = NULL;
+    this->irq_attached = false;
+    this->dma_tx_chan = -1;
+    this->dma_rx_chan = -1;
+    this->dma_irq_line = 0;
+    this->dma_busy = false;
+    this->dma_rx_dest = NULL;
+    this->dma_len = 0;
+}
+
+NRF24_PicoTransport::NRF24_PicoTransport(spi_inst_t *spi, uint16_t sck, uint16_t mosi, uint16_t miso, uint16_t csn, uint16_t ce, uint16_t irq)
+{
+    this->spi = spi;
+    this->sck = sck;
+    this->mosi = mosi;
+    this->miso = miso;
+    this->csn = csn;
+    this->ce = ce;
+    this->irq = irq;
+    this->irq_handler = NULL;
+    this->irq_context = NULL;
+    this->irq_attached = false;
+    this->dma_tx_chan = -1;
+    this->dma_rx_chan = -1;
+    this->dma_irq_line = 0;
+    this->dma_busy = false;
+    this->dma_rx_dest = NULL;
+    this->dma_len = 0;
+}
+
+NRF24_PicoTransport::~NRF24_PicoTransport()
+{
+    detachInterrupt();
+    disableDMA();
+}
+
+bool NRF24_PicoTransport::begin()
+{
+    if (!spi) return false;
+    
+    // Initialize SPI
+    spi_init(this->spi, 4000000); // Start with 4MHz for initialization
+    gpio_set_function(sck, GPIO_FUNC_SPI);
+    gpio_set_function(miso, GPIO_FUNC_SPI);
+    gpio_set_function(mosi, GPIO_FUNC_SPI);
+    
+    // Initialize control pins
+    gpio_init(csn);
+    gpio_init(ce);
+    gpio_set_dir(csn, GPIO_OUT);
+    gpio_set_dir(ce, GPIO_OUT);
+    
+    // Initialize IRQ pin if specified
+    if (irq != 0xFF) {
+        gpio_init(irq);
+        gpio_set_dir(irq, GPIO_IN);
+        gpio_pull_up(irq);
+    }
+    
+    // Set initial pin states
+    setCE(false);
+    csnHigh();
+    return true;
+}
+
+void NRF24_PicoTransport::setSpeed(uint32_t hz)
+{
+    spi_set_baudrate(this->spi, hz);
+}
+
+uint8_t NRF24_PicoTransport::transfer(uint8_t cmd, const uint8_t *tx, uint8_t *rx, uint8_t len)
+{
+    uint8_t status = 0;
+    csnLow();
+    spi_write_read_blocking(spi, &cmd, &status, 1);
+    if (len) {
+        if (rx) {
+            spi_read_blocking(spi, 0xFF, rx, len);
+        } else {
+            spi_write_blocking(spi, tx, len);
+        }
+    }
+    csnHigh();
+    return status;
+}
+
+// IRQ line
+bool NRF24_PicoTransport::attachInterrupt(NRF24_IrqHandler handler, void *context)
+{
+    if (irq == 0xFF) return false;
+    if (irq_attached) {
+        irq_handler = handler;
+        irq_context = context;
+        return true;
+    }
+    
+    int slot = -1;
+    for (int i = 0; i < NRF24_MAX_IRQ_INSTANCES; i++) {
+        if (!irq_instances[i]) {
+            slot = i;
+            break;
+        }
+    }
+    if (slot < 0) return false;
+    
+    irq_handler = handler;
+    irq_context = context;
+    irq_instance_pins[slot] = irq;
+    irq_instances[slot] = this;
+    if (!irq_handler_installed) {
+        // One shared handler walks the instance table for every radio. The vector
+        // table is shared by both cores, so it is installed once.
+        gpio_add_raw_irq_handler(irq, nrf24GpioIrqHandler);
+        irq_handler_installed = true;
+    }
+    
+    // The NVIC enable and the pin's edge interrupt are per core: this core services it
+    irq_set_enabled(IO_IRQ_BANK0, true);
+    irq_attached = true;
+    gpio_set_irq_enabled(irq, GPIO_IRQ_EDGE_FALL, true);
+    return true;
+}
+
+void NRF24_PicoTransport::detachInterrupt()
+{
+    if (!irq_attached) return;
+    
+    gpio_set_irq_enabled(irq, GPIO_IRQ_EDGE_FALL, false);
+    for (int i = 0; i < NRF24_MAX_IRQ_INSTANCES; i++) {
+        if (irq_instances[i] == this) {
+            irq_instances[i] = NULL;
+        }
+    }
+    irq_attached = false;
+}
+
+bool NRF24_PicoTransport::isIrqAsserted()
+{
+    return irq != 0xFF && !gpio_get(irq);
+}
+
+void NRF24_PicoTransport::handleGpioIrq()
+{
+    if (irq_handler) {
+        irq_handler(irq_context);
+    }
+}
+
+// DMA transport
+bool NRF24_PicoTransport::enableDMA()
+{
+    if (dma_tx_chan >= 0) return true;
+    
+    int slot = -1;
+    for (int i = 0; i < NRF24_MAX_IRQ_INSTANCES; i++) {
+        if (!dma_instances[i]) {
+            slot = i;
+            break;
+        }
+    }
+    if (slot < 0) return false;
+    
+    int tx_chan = dma_claim_unused_channel(false);
+    int rx_chan = dma_claim_unused_channel(false);
+    if (tx_chan < 0 || rx_chan < 0) {
+        if (tx_chan >= 0) dma_channel_unclaim(tx_chan);
+        if (rx_chan >= 0) dma_channel_unclaim(rx_chan);
+        return false;
+    }
+    
+    configureDMA(tx_chan, rx_chan);
+    
+    // Completions run on this core: its own IRQ line, so the other core's NVIC never
+    // sees them. The vector table is shared, so each line's handler is installed once.
+    uint line = get_core_num();
+    dma_instance_chans[slot] = rx_chan;
+    dma_instance_lines[slot] = line;
+    dma_instances[slot] = this;
+    if (!dma_handler_installed[line]) {
+        irq_add_shared_handler(DMA_IRQ_0 + line, line ? nrf24DmaIrq1Handler : nrf24DmaIrq0Handler,
+                               PICO_SHARED_IRQ_HANDLER_DEFAULT_ORDER_PRIORITY);
+        dma_handler_installed[line] = true;
+    }
+    irq_set_enabled(DMA_IRQ_0 + line, true);
+    dma_irqn_set_channel_enabled(line, rx_chan, true);
+    dma_irq_line = line;
+    
+    dma_tx_chan = tx_chan;
+    dma_rx_chan = rx_chan;
+    return true;
+}
+
+void NRF24_PicoTransport::configureDMA(int tx_chan, int rx_chan)
+{
+    // TX: buffer -> SPI data register, paced by the SPI TX DREQ
+    dma_channel_config tx_config = dma_channel_get_default_config(tx_chan);
+    channel_config_set_transfer_data_size(&tx_config, DMA_SIZE_8);
+    channel_config_set_dreq(&tx_config, spi_get_dreq(spi, true));
+    channel_config_set_read_increment(&tx_config, true);
+    channel_config_set_write_increment(&tx_config, false);
+    dma_channel_configure(tx_chan, &tx_config, &spi_get_hw(spi)->dr, dma_tx_buf, 0, false);
+    
+    // RX: SPI data register -> buffer, paced by the SPI RX DREQ
+    dma_channel_config rx_config = dma_channel_get_default_config(rx_chan);
+    channel_config_set_transfer_data_size(&rx_config, DMA_SIZE_8);
+    channel_config_set_dreq(&rx_config, spi_get_dreq(spi, false));
+    channel_config_set_read_increment(&rx_config, false);
+    channel_config_set_write_increment(&rx_config, true);
+    dma_channel_configure(rx_chan, &rx_config, dma_rx_buf, &spi_get_hw(spi)->dr, 0, false);
+}
+
+void NRF24_PicoTransport::disableDMA()
+{
+    if (dma_tx_chan < 0) return;
+    
+    waitTransfer();
+    dma_irqn_set_channel_enabled(dma_irq_line, dma_rx_chan, false);
+    for (int i = 0; i < NRF24_MAX_IRQ_INSTANCES; i++) {
+        if (dma_instances[i] == this) {
+            dma_instances[i] = NULL;
+        }
+    }
+    dma_channel_unclaim(dma_tx_chan);
+    dma_channel_unclaim(dma_rx_chan);
+    dma_tx_chan = -1;
+    dma_rx_chan = -1;
+}
+
+bool NRF24_PicoTransport::isDMAEnabled()
+{
+    return dma_tx_chan >= 0;
+}
+
+bool NRF24_PicoTransport::startTransfer(uint8_t cmd, const uint8_t *tx, uint8_t *rx, uint8_t len)
+{
+    if (dma_tx_chan < 0 || len < NRF24_DMA_MIN_LENGTH || len > NRF24_MAX_TRANSFER_SIZE - 1) {
+        return false;
+    }
+    
+    waitTransfer();
+    dma_tx_buf[0] = cmd;
+    if (tx) {
+        memcpy(dma_tx_buf + 1, tx, len);
+    } else {
+        memset(dma_tx_buf + 1, 0xFF, len);
+    }
+    dma_rx_dest = rx;
+    dma_len = len;
+    
+    dma_busy = true;
+    csnLow();
+    dma_channel_set_write_addr(dma_rx_chan, dma_rx_buf, false);
+    dma_channel_set_trans_count(dma_rx_chan, len + 1, false);
+    dma_channel_set_read_addr(dma_tx_chan, dma_tx_buf, false);
+    dma_channel_set_trans_count(dma_tx_chan, len + 1, false);
+    dma_start_channel_mask((1u << dma_tx_chan) | (1u << dma_rx_chan));
+    return true;
+}
+
+bool NRF24_PicoTransport::isTransferPending()
+{
+    return dma_busy;
+}
+
+void NRF24_PicoTransport::waitTransfer()
+{
+    while (dma_busy) {
+        // Complete inline if the DMA IRQ cannot run (e.g. we were called from another ISR)
+        uint32_t irq_state = save_and_disable_interrupts();
+        if (dma_busy && dma_irqn_get_channel_status(dma_irq_line, dma_rx_chan)) {
+            dma_irqn_acknowledge_channel(dma_irq_line, dma_rx_chan);
+            handleDMAComplete();
+        }
+        restore_interrupts(irq_state);
+    }
+}
+
+// RX channel completion: every byte has been clocked, so the transaction can be closed
+void NRF24_PicoTransport::handleDMAComplete()
+{
+    csnHigh();
+    if (dma_rx_dest) {
+        memcpy(dma_rx_dest, dma_rx_buf + 1, dma_len);
+        dma_rx_dest = NULL;
+    }
+    dma_busy = false;
+    
+    if (transfer_callback) {
+        transfer_callback(transfer_context, dma_rx_buf[0]);
+    }
+}
@@ -0,0 +1,84 @@
+
+#ifndef __NRF24_PICOTRANSPORT_H_
+#define __NRF24_PICOTRANSPORT_H_
+
+#include "pico/stdlib.h"
+#include "hardware/spi.h"
+#include "hardware/gpio.h"
+#include "NRF24_Transport.h"
+
+// Payload transfers shorter than this stay on the blocking SPI path
+#define NRF24_DMA_MIN_LENGTH        8
+
+// Radios that can share the GPIO and DMA interrupt handlers
+#define NRF24_MAX_IRQ_INSTANCES     4
+
+// Largest transaction: command byte plus a full payload
+#define NRF24_MAX_TRANSFER_SIZE     33
+
+// Pico SDK transport: hardware SPI, SIO GPIO for CSN/CE, GPIO IRQ and optional DMA
+class NRF24_PicoTransport : public NRF24_Transport
+{
+protected:
+    spi_inst_t *spi;
+    uint16_t sck;
+    uint16_t mosi;
+    uint16_t miso;
+    uint16_t csn;
+    uint16_t ce;
+    uint16_t irq;
+    
+    // IRQ line
+    NRF24_IrqHandler irq_handler;
+    void *irq_context;
+    bool irq_attached;
+    
+    // DMA transport
+    int dma_tx_chan;
+    int dma_rx_chan;
+    uint8_t dma_irq_line;   // DMA_IRQ_0 + the core that called enableDMA()
+    volatile bool dma_busy;
+    uint8_t *dma_rx_dest;
+    uint8_t dma_len;
+    uint8_t dma_tx_buf[NRF24_MAX_TRANSFER_SIZE];
+    uint8_t dma_rx_buf[NRF24_MAX_TRANSFER_SIZE];
+    
+    void csnLow() { gpio_put(csn, 0); }
+    void csnHigh() { gpio_put(csn, 1); }
+    
+    // Point freshly claimed channels at the bus; TX paced by its DREQ. enableDMA() routes
+    // the RX channel's completion to the calling core's DMA IRQ line.
+    virtual void configureDMA(int tx_chan, int rx_chan);
+
+public:
+    NRF24_PicoTransport();
+    NRF24_PicoTransport(spi_inst_t *spi, uint16_t sck, uint16_t mosi, uint16_t miso, uint16_t csn, uint16_t ce, uint16_t irq);
+    ~NRF24_PicoTransport();
+    
+    bool begin();
+    void setSpeed(uint32_t hz);
+    uint8_t transfer(uint8_t cmd, const uint8_t *tx, uint8_t *rx, uint8_t len);
+    void setCE(bool high) { gpio_put(ce, high); }
+    
+    void delayUs(uint32_t us) { sleep_us(us); }
+    uint32_t micros() { return time_us_32(); }
+    
+    bool attachInterrupt(NRF24_IrqHandler handler, void *context);
+    void detachInterrupt();
+    bool isIrqAsserted();
+    uint32_t enterCritical() { return save_and_disable_interrupts(); }
+    void exitCritical(uint32_t state) { restore_interrupts(state); }
+    
+    bool enableDMA();
+    void disableDMA();
+    bool isDMAEnabled();
+    bool startTransfer(uint8_t cmd, const uint8_t *tx, uint8_t *rx, uint8_t len);
+    bool isTransferPending();
+    void waitTransfer();
+    
+    // Called from the shared interrupt handlers
+    void handleGpioIrq();
+    void handleDMAComplete();
+};
+
+#endif
@@ -0,0 +1,51 @@
+// -------------------------------------------------- //
+// Assembled from NRF24_Pio.pio in pioasm's C SDK     //
+// output format; regenerate with pioasm, do not edit //
+// -------------------------------------------------- //
+
+#pragma once
+
+#if !PICO_NO_HARDWARE
+#include "hardware/pio.h"
+#endif
+
+// --------- //
+// nrf24_spi //
+// --------- //
+
+#define nrf24_spi_wrap_target 0
+#define nrf24_spi_wrap 11
+
+#define nrf24_spi_offset_start 0u
+
+static const uint16_t nrf24_spi_program_instructions[] = {
+            //     .wrap_target
+    0x90a0, //  0: pull   block           side 2
+    0x7030, //  1: out    x, 16           side 2
+    0x7050, //  2: out    y, 16           side 2
+    0x1028, //  3: jmp    !x, 8           side 2
+    0x0045, //  4: jmp    x--, 5          side 0
+    0x6101, //  5: out    pins, 1         side 0 [1]
+    0x4801, //  6: in     pins, 1         side 1
+    0x0845, //  7: jmp    x--, 5          side 1
+    0x1060, //  8: jmp    !y, 0           side 2
+    0xf001, //  9: set    pins, 1         side 2
+    0x178a, // 10: jmp    y--, 10         side 2 [7]
+    0xf000, // 11: set    pins, 0         side 2
+            //     .wrap
+};
+
+#if !PICO_NO_HARDWARE
+static const struct pio_program nrf24_spi_program = {
+    .instructions = nrf24_spi_program_instructions,
+    .length = 12,
+    .origin = -1,
+};
+
+static inline pio_sm_config nrf24_spi_program_get_default_config(uint offset) {
+    pio_sm_config c = pio_get_default_sm_config();
+    sm_config_set_wrap(&c, offset + nrf24_spi_wrap_target, offset + nrf24_spi_wrap);
+    sm_config_set_sideset(&c, 2, false, false);
+    return c;
+}
+#endif
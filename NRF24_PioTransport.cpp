@@ -0,0 +1,214 @@
+#include "NRF24_PioTransport.h"
+#include "NRF24_Pio.pio.h"
+#include "hardware/clocks.h"
+#include "hardware/dma.h"
+
+// One copy of the program per PIO block, shared by every radio on it
+static uint program_offsets[NUM_PIOS];
+static uint8_t program_users[NUM_PIOS];
+
+// Constructor
+NRF24_PioTransport::NRF24_PioTransport(PIO pio, uint16_t sck, uint16_t mosi, uint16_t miso, uint16_t csn, uint16_t ce, uint16_t irq)
+{
+    this->pio = pio;
+    this->sm = -1;
+    this->offset = 0;
+    this->sm_hz = 0;
+    this->sck = sck;
+    this->mosi = mosi;
+    this->miso = miso;
+    this->csn = csn;
+    this->ce = ce;
+    this->irq = irq;
+}
+
+NRF24_PioTransport::~NRF24_PioTransport()
+{
+    if (sm < 0) return;
+    
+    waitIdle();
+    pio_sm_set_enabled(pio, sm, false);
+    pio_sm_unclaim(pio, sm);
+    uint index = pio_get_index(pio);
+    if (--program_users[index] == 0) {
+        pio_remove_program(pio, &nrf24_spi_program, program_offsets[index]);
+    }
+    sm = -1;
+}
+
+bool NRF24_PioTransport::begin()
+{
+    if (!pio || csn != sck + 1) return false;
+    if (sm >= 0) return true;
+    
+    // Load the program unless another radio on this PIO already has
+    uint index = pio_get_index(pio);
+    if (program_users[index] == 0) {
+        if (!pio_can_add_program(pio, &nrf24_spi_program)) return false;
+        program_offsets[index] = pio_add_program(pio, &nrf24_spi_program);
+    }
+    int claimed = pio_claim_unused_sm(pio, false);
+    if (claimed < 0) {
+        if (program_users[index] == 0) {
+            pio_remove_program(pio, &nrf24_spi_program, program_offsets[index]);
+        }
+        return false;
+    }
+    program_users[index]++;
+    sm = claimed;
+    offset = program_offsets[index];
+    
+    pio_sm_config config = nrf24_spi_program_get_default_config(offset);
+    sm_config_set_out_pins(&config, mosi, 1);
+    sm_config_set_in_pins(&config, miso);
+    sm_config_set_set_pins(&config, ce, 1);
+    sm_config_set_sideset_pins(&config, sck);
+    sm_config_set_out_shift(&config, false, true, 32);  // MSB first, descriptor and data words
+    sm_config_set_in_shift(&config, false, true, 8);    // One received byte per RX FIFO entry
+    
+    // Idle levels before the pins are handed over: CSN high, SCK, MOSI and CE low
+    uint32_t outputs = (1u << sck) | (1u << csn) | (1u << mosi) | (1u << ce);
+    pio_sm_set_pins_with_mask(pio, sm, 1u << csn, outputs);
+    pio_sm_set_pindirs_with_mask(pio, sm, outputs, outputs | (1u << miso));
+    pio_gpio_init(pio, sck);
+    pio_gpio_init(pio, csn);
+    pio_gpio_init(pio, mosi);
+    pio_gpio_init(pio, miso);
+    pio_gpio_init(pio, ce);
+    
+    // Initialize IRQ pin if specified
+    if (irq != 0xFF) {
+        gpio_init(irq);
+        gpio_set_dir(irq, GPIO_IN);
+        gpio_pull_up(irq);
+    }
+    
+    pio_sm_init(pio, sm, offset, &config);
+    pio_sm_set_enabled(pio, sm, true);
+    setSpeed(4000000); // Start with 4MHz for initialization
+    return true;
+}
+
+// Any SCK up to the chip's limit; the fractional divider needs no rounding to a prescaler
+void NRF24_PioTransport::setSpeed(uint32_t hz)
+{
+    if (sm < 0 || hz == 0) return;
+    if (hz > NRF24_PIO_MAX_SPEED) hz = NRF24_PIO_MAX_SPEED;
+    
+    float div = (float)clock_get_hz(clk_sys) / ((float)hz * NRF24_PIO_CYCLES_PER_BIT);
+    if (div < 1.0f) div = 1.0f;
+    waitIdle();
+    pio_sm_set_clkdiv(pio, sm, div);
+    sm_hz = (uint32_t)(clock_get_hz(clk_sys) / div);
+}
+
+// Descriptor (bit count, no CE pulse) followed by the bytes, four to a word, MSB first.
+// Read transactions clock out 0xFF like the SPI transport. Returns the word count.
+uint8_t NRF24_PioTransport::pack(uint8_t cmd, const uint8_t *tx, uint8_t len)
+{
+    uint8_t count = len + 1;
+    tx_words[0] = (uint32_t)count * 8 << 16;
+    for (uint8_t i = 0; i < count; i++) {
+        uint8_t byte = i == 0 ? cmd : (tx ? tx[i - 1] : 0xFF);
+        uint32_t *word = &tx_words[1 + (i >> 2)];
+        if ((i & 3) == 0) *word = 0;
+        *word |= (uint32_t)byte << (24 - 8 * (i & 3));
+    }
+    return 1 + (count + 3) / 4;
+}
+
+uint8_t NRF24_PioTransport::transfer(uint8_t cmd, const uint8_t *tx, uint8_t *rx, uint8_t len)
+{
+    uint8_t words = pack(cmd, tx, len);
+    uint8_t sent = 0;
+    uint8_t received = 0;
+    uint8_t status = 0;
+    
+    // Keep both FIFOs moving: a full payload is more words than the TX FIFO holds
+    while (received <= len) {
+        if (sent < words && !pio_sm_is_tx_fifo_full(pio, sm)) {
+            pio->txf[sm] = tx_words[sent++];
+        }
+        if (!pio_sm_is_rx_fifo_empty(pio, sm)) {
+            uint8_t byte = (uint8_t)pio->rxf[sm];
+            if (received == 0) {
+                status = byte;
+            } else if (rx) {
+                rx[received - 1] = byte;
+            }
+            received++;
+        }
+    }
+    return status;
+}
+
+// Descriptors run in order, so the state machine is idle once it stalls on the next one
+void NRF24_PioTransport::waitIdle()
+{
+    waitTransfer();
+    uint32_t stall = 1u << (PIO_FDEBUG_TXSTALL_LSB + sm);
+    pio->fdebug = stall;
+    while (!pio_sm_is_tx_fifo_empty(pio, sm) || !(pio->fdebug & stall)) {
+        tight_loop_contents();
+    }
+}
+
+// CE belongs to the state machine, so a level change is an instruction executed on it,
+// after any queued pulse has finished
+void NRF24_PioTransport::setCE(bool high)
+{
+    if (sm < 0) return;
+    waitIdle();
+    pio_sm_exec(pio, sm, pio_encode_set(pio_pins, high ? 1 : 0) | pio_encode_sideset(2, 2));
+}
+
+bool NRF24_PioTransport::pulseCE(uint32_t us)
+{
+    if (sm < 0) return false;
+    
+    // The program holds CE high for (steps + 1) x NRF24_PIO_CYCLES_PER_STEP cycles
+    uint64_t steps = (uint64_t)us * sm_hz / (1000000u * NRF24_PIO_CYCLES_PER_STEP);
+    if (steps < 1) steps = 1;
+    if (steps > 0xFFFF) steps = 0xFFFF;
+    waitTransfer();  // A DMA transfer may still be feeding the FIFO
+    pio_sm_put_blocking(pio, sm, (uint32_t)steps);
+    return true;
+}
+
+// DMA transport: 32-bit words into the TX FIFO, received bytes out of the RX FIFO
+void NRF24_PioTransport::configureDMA(int tx_chan, int rx_chan)
+{
+    dma_channel_config tx_config = dma_channel_get_default_config(tx_chan);
+    channel_config_set_transfer_data_size(&tx_config, DMA_SIZE_32);
+    channel_config_set_dreq(&tx_config, pio_get_dreq(pio, sm, true));
+    channel_config_set_read_increment(&tx_config, true);
+    channel_config_set_write_increment(&tx_config, false);
+    dma_channel_configure(tx_chan, &tx_config, &pio->txf[sm], tx_words, 0, false);
+    
+    dma_channel_config rx_config = dma_channel_get_default_config(rx_chan);
+    channel_config_set_transfer_data_size(&rx_config, DMA_SIZE_8);
+    channel_config_set_dreq(&rx_config, pio_get_dreq(pio, sm, false));
+    channel_config_set_read_increment(&rx_config, false);
+    channel_config_set_write_increment(&rx_config, true);
+    dma_channel_configure(rx_chan, &rx_config, dma_rx_buf, &pio->rxf[sm], 0, false);
+}
+
+bool NRF24_PioTransport::startTransfer(uint8_t cmd, const uint8_t *tx, uint8_t *rx, uint8_t len)
+{
+    if (dma_tx_chan < 0 || len < NRF24_DMA_MIN_LENGTH || len > NRF24_MAX_TRANSFER_SIZE - 1) {
+        return false;
+    }
+    
+    waitTransfer();
+    uint8_t words = pack(cmd, tx, len);
+    dma_rx_dest = rx;
+    dma_len = len;
+    
+    dma_busy = true;
+    dma_channel_set_write_addr(dma_rx_chan, dma_rx_buf, false);
+    dma_channel_set_trans_count(dma_rx_chan, len + 1, false);
+    dma_channel_set_read_addr(dma_tx_chan, tx_words, false);
+    dma_channel_set_trans_count(dma_tx_chan, words, false);
+    dma_start_channel_mask((1u << dma_tx_chan) | (1u << dma_rx_chan));
+    return true;
+}
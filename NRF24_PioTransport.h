@@ -0,0 +1,47 @@
+
+#ifndef __NRF24_PIOTRANSPORT_H_
+#define __NRF24_PIOTRANSPORT_H_
+
+#include "hardware/pio.h"
+#include "NRF24_PicoTransport.h"
+
+// SCK ceiling: the nRF24L01+ SPI limit
+#define NRF24_PIO_MAX_SPEED         10000000
+
+// PIO cycles per SCK period and per CE pulse step (see NRF24_Pio.pio)
+#define NRF24_PIO_CYCLES_PER_BIT    4
+#define NRF24_PIO_CYCLES_PER_STEP   8
+
+// Descriptor plus a full transaction packed four bytes to a word
+#define NRF24_PIO_MAX_WORDS         (1 + (NRF24_MAX_TRANSFER_SIZE + 3) / 4)
+
+// PIO transport: one state machine runs each transaction (CSN, SCK, MOSI/MISO and
+// an optional timed CE pulse) from a descriptor in its TX FIFO, with no gaps
+// between bytes. Any free GPIOs work as long as CSN is SCK + 1. The IRQ line,
+// timing and DMA bookkeeping are the Pico transport's.
+class NRF24_PioTransport : public NRF24_PicoTransport
+{
+private:
+    PIO pio;
+    int sm;
+    uint offset;
+    uint32_t sm_hz;         // State machine clock, NRF24_PIO_CYCLES_PER_BIT x SCK
+    uint32_t tx_words[NRF24_PIO_MAX_WORDS];
+    
+    uint8_t pack(uint8_t cmd, const uint8_t *tx, uint8_t len);
+    void waitIdle();
+    void configureDMA(int tx_chan, int rx_chan);
+
+public:
+    NRF24_PioTransport(PIO pio, uint16_t sck, uint16_t mosi, uint16_t miso, uint16_t csn, uint16_t ce, uint16_t irq);
+    ~NRF24_PioTransport();
+    
+    bool begin();
+    void setSpeed(uint32_t hz);
+    uint8_t transfer(uint8_t cmd, const uint8_t *tx, uint8_t *rx, uint8_t len);
+    void setCE(bool high);
+    bool pulseCE(uint32_t us);
+    bool startTransfer(uint8_t cmd, const uint8_t *tx, uint8_t *rx, uint8_t len);
+};
+
+#endif
@@ -0,0 +1,248 @@
+#include "NRF24_RadioCore.h"
+#include "pico/multicore.h"
+#include "hardware/sync.h"
+#include <string.h>
+
+// Core 1 has a single entry point, so only one radio core can run at a time
+static NRF24_RadioCore *core1_instance = NULL;
+
+// Constructor
+NRF24_RadioCore::NRF24_RadioCore(NRF24 *radio)
+{
+    this->radio = radio;
+    this->rx_storage = NULL;
+    this->rx_count = 0;
+    this->tx_seq = 0;
+    this->tx_done_seq = 0;
+    this->tx_acked = 0;
+    this->tx_failed = 0;
+    this->running = false;
+    this->dma_enabled = false;
+    
+    for (int i = 0; i < NRF24_CORE_RESULT_LOG; i++) {
+        tx_results[i] = 0;
+    }
+}
+
+// Start the radio loop on core 1. The radio must already be configured (begin(),
+// addresses, channel...); from here on core 0 may only use the proxy API. The IRQ
+// engine and DMA move to core 1, so registered callbacks run there.
+bool NRF24_RadioCore::launch(NRF24_Packet *rx_storage, uint16_t rx_count)
+{
+    if (running || core1_instance || !rx_storage || rx_count < 2) return false;
+    
+    this->rx_storage = rx_storage;
+    this->rx_count = rx_count;
+    tx_queue.init(tx_storage, NRF24_CORE_TX_QUEUE);
+    
+    // Interrupts and DMA completions are serviced by the core that enabled them, and
+    // enableInterrupts(), enableRxBuffer() or enableAckQueue() may already have done
+    // so here. Release both on this core (the GPIO enable can only be cleared from the
+    // core that set it); run() enables them again on core 1.
+    radio->disableInterrupts();
+    dma_enabled = radio->isDMAEnabled();
+    if (dma_enabled) {
+        radio->disableDMA();
+    }
+    
+    core1_instance = this;
+    multicore_launch_core1(core1Entry);
+    while (!running) {
+        tight_loop_contents();
+    }
+    return true;
+}
+
+void NRF24_RadioCore::stop()
+{
+    if (!running) return;
+    
+    post(NRF24_CORE_CMD_STOP, NULL, 0, NULL);
+    while (running) {
+        tight_loop_contents();
+    }
+    multicore_reset_core1();
+    core1_instance = NULL;
+    
+    // The radio is core 0's again
+    if (dma_enabled) {
+        radio->enableDMA();
+    }
+}
+
+bool NRF24_RadioCore::isRunning()
+{
+    return running;
+}
+
+void NRF24_RadioCore::core1Entry()
+{
+    core1_instance->run();
+}
+
+// Radio core main loop. Owns the SPI bus and the NRF24 instance.
+void NRF24_RadioCore::run()
+{
+    // The IRQ engine and DMA completions are per core, so they have to be enabled from here
+    if (dma_enabled) {
+        radio->enableDMA();
+    }
+    bool irq_driven = radio->enableRxBuffer(rx_storage, rx_count);
+    bool listening = false;
+    running = true;
+    
+    while (true) {
+        NRF24_CoreRequest *request;
+        while ((request = tx_queue.peek()) != NULL) {
+            switch (request->command) {
+                case NRF24_CORE_CMD_WRITE:
+                case NRF24_CORE_CMD_WRITE_NO_ACK: {
+                    bool result = radio->write(request->data, request->length,
+                                               request->command == NRF24_CORE_CMD_WRITE_NO_ACK);
+                    tx_results[request->seq % NRF24_CORE_RESULT_LOG] = result;
+                    if (result) {
+                        tx_acked = tx_acked + 1;
+                    } else {
+                        tx_failed = tx_failed + 1;
+                    }
+                    __dmb(); // Result visible before the completion count moves
+                    tx_done_seq = request->seq + 1;
+                    if (listening) {
+                        radio->startListening();
+                    }
+                    break;
+                }
+                case NRF24_CORE_CMD_START_LISTENING:
+                    listening = true;
+                    radio->startListening();
+                    break;
+                case NRF24_CORE_CMD_STOP_LISTENING:
+                    listening = false;
+                    radio->stopListening();
+                    break;
+                case NRF24_CORE_CMD_STOP:
+                    tx_queue.release();
+                    radio->disableInterrupts();
+                    radio->disableDMA();
+                    __dmb();
+                    running = false;
+                    return;
+            }
+            tx_queue.release();
+        }
+        
+        // Doorbells only wake us; the queue is the source of truth
+        while (multicore_fifo_rvalid()) {
+            multicore_fifo_pop_blocking();
+        }
+        
+        if (irq_driven || !listening) {
+            __wfe(); // Woken by a doorbell or the radio IRQ
+        } else {
+            radio->handleInterrupt(); // No IRQ pin: poll the RX FIFO into the ring
+        }
+    }
+}
+
+bool NRF24_RadioCore::post(uint8_t command, uint8_t *data, uint8_t len, uint32_t *seq)
+{
+    NRF24_CoreRequest *request;
+    while ((request = tx_queue.reserve()) == NULL) {
+        if (!running) return false;
+        tight_loop_contents();
+    }
+    
+    request->command = command;
+    request->length = len;
+    if (data) {
+        memcpy(request->data, data, len);
+    }
+    if (seq) {
+        request->seq = tx_seq++;
+        *seq = request->seq;
+    }
+    tx_queue.commit();
+    doorbell();
+    return true;
+}
+
+void NRF24_RadioCore::doorbell()
+{
+    // A full FIFO already holds a pending doorbell
+    if (multicore_fifo_wready()) {
+        multicore_fifo_push_blocking(0);
+    }
+}
+
+// Proxy API
+bool NRF24_RadioCore::write(uint8_t *data, uint8_t len)
+{
+    return write(data, len, false);
+}
+
+bool NRF24_RadioCore::write(uint8_t *data, uint8_t len, bool multicast)
+{
+    if (!running || len > NRF_MAX_PAYLOAD_SIZE) return false;
+    
+    uint32_t seq;
+    if (!post(multicast ? NRF24_CORE_CMD_WRITE_NO_ACK : NRF24_CORE_CMD_WRITE, data, len, &seq)) {
+        return false;
+    }
+    while ((int32_t)(tx_done_seq - (seq + 1)) < 0) {
+        tight_loop_contents();
+    }
+    __dmb(); // Pairs with the barrier before tx_done_seq on core 1
+    return tx_results[seq % NRF24_CORE_RESULT_LOG] != 0;
+}
+
+// Queue a write without waiting. Returns false if the request queue is full.
+bool NRF24_RadioCore::startWrite(uint8_t *data, uint8_t len, bool multicast)
+{
+    if (!running || len > NRF_MAX_PAYLOAD_SIZE || !tx_queue.reserve()) return false;
+    
+    uint32_t seq;
+    return post(multicast ? NRF24_CORE_CMD_WRITE_NO_ACK : NRF24_CORE_CMD_WRITE, data, len, &seq);
+}
+
+bool NRF24_RadioCore::available()
+{
+    return radio->rxBuffered() > 0;
+}
+
+uint8_t NRF24_RadioCore::read(uint8_t *data, uint8_t len, uint8_t *pipe_num)
+{
+    NRF24_Packet packet;
+    if (!radio->receive(&packet)) return 0;
+    
+    uint8_t copy_len = packet.length < len ? packet.length : len;
+    memcpy(data, packet.data, copy_len);
+    if (pipe_num) {
+        *pipe_num = packet.pipe;
+    }
+    return copy_len;
+}
+
+void NRF24_RadioCore::startListening()
+{
+    post(NRF24_CORE_CMD_START_LISTENING, NULL, 0, NULL);
+}
+
+void NRF24_RadioCore::stopListening()
+{
+    post(NRF24_CORE_CMD_STOP_LISTENING, NULL, 0, NULL);
+}
+
+uint32_t NRF24_RadioCore::getPendingWrites()
+{
+    return tx_seq - tx_done_seq;
+}
+
+uint32_t NRF24_RadioCore::getWritesAcked()
+{
+    return tx_acked;
+}
+
+uint32_t NRF24_RadioCore::getWritesFailed()
+{
+    return tx_failed;
+}
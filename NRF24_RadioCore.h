@@ -0,0 +1,79 @@
+
+#ifndef __NRF24_RADIOCORE_H_
+#define __NRF24_RADIOCORE_H_
+
+#include "NRF24.h"
+
+// Queue sizes for the core 0 -> core 1 request path
+#define NRF24_CORE_TX_QUEUE         8
+#define NRF24_CORE_RESULT_LOG       32
+
+// Requests posted from core 0 to the radio core
+enum NRF24_CoreCommand {
+    NRF24_CORE_CMD_WRITE = 0,
+    NRF24_CORE_CMD_WRITE_NO_ACK = 1,
+    NRF24_CORE_CMD_START_LISTENING = 2,
+    NRF24_CORE_CMD_STOP_LISTENING = 3,
+    NRF24_CORE_CMD_STOP = 4
+};
+
+typedef struct {
+    uint8_t command;
+    uint8_t length;
+    uint32_t seq;
+    uint8_t data[NRF_MAX_PAYLOAD_SIZE];
+} NRF24_CoreRequest;
+
+// Runs an NRF24 on core 1, which then owns the SPI bus. Core 0 talks to it only
+// through lock-free queues; the SIO FIFO is used as a doorbell to wake core 1.
+class NRF24_RadioCore
+{
+private:
+    NRF24 *radio;
+    NRF24_Packet *rx_storage;
+    uint16_t rx_count;
+    
+    NRF24_CoreRequest tx_storage[NRF24_CORE_TX_QUEUE];
+    NRF24_Ring<NRF24_CoreRequest> tx_queue;
+    
+    // Written by core 0 only
+    uint32_t tx_seq;
+    
+    // Written by core 1 only
+    volatile uint32_t tx_done_seq;
+    volatile uint8_t tx_results[NRF24_CORE_RESULT_LOG];
+    volatile uint32_t tx_acked;
+    volatile uint32_t tx_failed;
+    volatile bool running;
+    bool dma_enabled;           // Released on core 0 by launch(), claimed again by run()
+    
+    bool post(uint8_t command, uint8_t *data, uint8_t len, uint32_t *seq);
+    void doorbell();
+    void run();
+    static void core1Entry();
+
+public:
+    NRF24_RadioCore(NRF24 *radio);
+    
+    // Configure the radio on core 0 first, then hand it over. Interrupts and DMA
+    // enabled on core 0 are moved to core 1; stop() leaves interrupts disabled.
+    bool launch(NRF24_Packet *rx_storage, uint16_t rx_count);
+    void stop();
+    bool isRunning();
+    
+    // Proxy API, called from core 0
+    bool write(uint8_t *data, uint8_t len);
+    bool write(uint8_t *data, uint8_t len, bool multicast);
+    bool startWrite(uint8_t *data, uint8_t len, bool multicast = false);
+    bool available();
+    uint8_t read(uint8_t *data, uint8_t len, uint8_t *pipe_num = NULL);
+    void startListening();
+    void stopListening();
+    
+    // Outcome of requests queued with startWrite()
+    uint32_t getPendingWrites();
+    uint32_t getWritesAcked();
+    uint32_t getWritesFailed();
+};
+
+#endif
@@ -0,0 +1,104 @@
+#include "NRF24_Scanner.h"
+#include <string.h>
+
+// Constructor
+NRF24_Scanner::NRF24_Scanner(NRF24 *radio)
+{
+    this->radio = radio;
+    this->first = 0;
+    this->last = NRF_MAX_CHANNEL;
+    this->listen_us = NRF24_RPD_MIN_US;
+    reset();
+}
+
+void NRF24_Scanner::setRange(uint8_t first, uint8_t last)
+{
+    if (last > NRF_MAX_CHANNEL) last = NRF_MAX_CHANNEL;
+    if (first > last) first = last;
+    this->first = first;
+    this->last = last;
+}
+
+void NRF24_Scanner::setListenTime(uint16_t listen_us)
+{
+    this->listen_us = listen_us < NRF24_RPD_MIN_US ? NRF24_RPD_MIN_US : listen_us;
+}
+
+void NRF24_Scanner::reset()
+{
+    memset(hits, 0, sizeof(hits));
+    sweeps = 0;
+}
+
+void NRF24_Scanner::sweep(uint16_t count)
+{
+    uint8_t channel = radio->getChannel();
+    bool was_listening = radio->getRadioState() == NRF24_STATE_RX;
+    
+    while (count--) {
+        // Halve the history rather than let the counters wrap
+        if (sweeps == 0xFFFF) {
+            for (uint8_t ch = 0; ch < NRF24_SCAN_CHANNELS; ch++) {
+                hits[ch] /= 2;
+            }
+            sweeps /= 2;
+        }
+        
+        for (uint8_t ch = first; ch <= last; ch++) {
+            if (radio->sampleCarrier(ch, listen_us)) {
+                hits[ch]++;
+            }
+        }
+        sweeps++;
+    }
+    
+    radio->setChannel(channel);
+    if (!was_listening) {
+        radio->stopListening();
+    }
+}
+
+uint16_t NRF24_Scanner::getHits(uint8_t channel)
+{
+    return channel <= NRF_MAX_CHANNEL ? hits[channel] : 0;
+}
+
+uint8_t NRF24_Scanner::getOccupancy(uint8_t channel)
+{
+    if (!sweeps || channel > NRF_MAX_CHANNEL) return 0;
+    return (uint32_t)hits[channel] * 100 / sweeps;
+}
+
+// Own hits dominate; busy neighbours only break ties
+uint32_t NRF24_Scanner::score(uint8_t channel)
+{
+    uint32_t nearby = 0;
+    for (int16_t ch = (int16_t)channel - NRF24_SCAN_NEIGHBOURS; ch <= channel + NRF24_SCAN_NEIGHBOURS; ch++) {
+        if (ch >= 0 && ch <= NRF_MAX_CHANNEL && ch != channel) {
+            nearby += hits[ch];
+        }
+    }
+    return ((uint32_t)hits[channel] << 16) + (nearby < 0xFFFF ? nearby : 0xFFFF);
+}
+
+uint8_t NRF24_Scanner::getQuietest(uint8_t *channels, uint8_t max)
+{
+    // Insertion sort into the caller's array, keeping only the best max entries
+    uint8_t count = 0;
+    for (uint8_t ch = first; ch <= last; ch++) {
+        uint32_t s = score(ch);
+        uint8_t pos = count;
+        while (pos > 0 && score(channels[pos - 1]) > s) {
+            pos--;
+        }
+        if (pos >= max) continue;
+        
+        uint8_t end = count < max ? count : max - 1;
+        for (uint8_t i = end; i > pos; i--) {
+            channels[i] = channels[i - 1];
+        }
+        channels[pos] = ch;
+        if (count < max) count++;
+    }
+    return count;
+}
@@ -0,0 +1,43 @@
+
+#ifndef __NRF24_SCANNER_H_
+#define __NRF24_SCANNER_H_
+
+#include "NRF24.h"
+
+#define NRF24_SCAN_CHANNELS         (NRF_MAX_CHANNEL + 1)
+#define NRF24_SCAN_NEIGHBOURS       2     // Channels either side used to break ties
+
+// RPD spectrum scanner. Each sweep samples every channel in the range once, keeping
+// the radio listening and only dropping CE around the RF_CH write (about 175 us per
+// channel, ~22 ms for all 126). Hits accumulate in a per-channel histogram.
+class NRF24_Scanner
+{
+private:
+    NRF24 *radio;
+    uint16_t hits[NRF24_SCAN_CHANNELS];
+    uint16_t sweeps;
+    uint8_t first;
+    uint8_t last;
+    uint16_t listen_us;
+    
+    uint32_t score(uint8_t channel);
+
+public:
+    NRF24_Scanner(NRF24 *radio);
+    
+    void setRange(uint8_t first, uint8_t last);
+    void setListenTime(uint16_t listen_us);
+    
+    // Run sweeps, then restore the channel and leave RX mode if it was not listening
+    void sweep(uint16_t count = 1);
+    void reset();
+    
+    uint16_t getSweeps() { return sweeps; }
+    uint16_t getHits(uint8_t channel);
+    uint8_t getOccupancy(uint8_t channel);   // Percent of sweeps with a carrier
+    
+    // Fill channels[] with up to max channels of the range, quietest first
+    uint8_t getQuietest(uint8_t *channels, uint8_t max);
+};
+
+#endif
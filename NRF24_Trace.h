@@ -0,0 +1,174 @@
+
+#ifndef __NRF24_TRACE_H_
+#define __NRF24_TRACE_H_
+
+#include "NRF24_Transport.h"
+
+// SPI transaction tracer. Compiled in with -DNRF24_TRACE=1; otherwise the hooks
+// expand to nothing and cost neither code nor RAM.
+#ifndef NRF24_TRACE
+#define NRF24_TRACE                 0
+#endif
+
+#ifndef NRF24_TRACE_SIZE
+#define NRF24_TRACE_SIZE            256     // Entries per radio, a power of two
+#endif
+
+#define NRF24_TRACE_ASYNC           0x80    // In len: handed to DMA, duration covers the setup only
+#define NRF24_TRACE_MAGIC           0x544E  // "NT" in the dump header
+#define NRF24_TRACE_VERSION         1
+#define NRF24_TRACE_HEADER_SIZE     16
+#define NRF24_TRACE_ENTRY_SIZE      8
+
+// One SPI transaction
+typedef struct {
+    uint32_t start_us;      // Timer microseconds when the transaction started
+    uint16_t duration;      // Trace ticks (CPU cycles on the Pico), saturated at 0xFFFF
+    uint8_t cmd;            // Command byte, register number included
+    uint8_t len;            // Data bytes after the command, | NRF24_TRACE_ASYNC
+} NRF24_TraceEntry;
+
+#if NRF24_TRACE
+
+#if NRF24_PICO
+#include "hardware/structs/systick.h"
+#include "hardware/clocks.h"
+#include "hardware/timer.h"
+#endif
+
+typedef struct {
+    uint32_t start_us;
+    uint32_t start_ticks;
+} NRF24_TraceMark;
+
+// Ring of the last NRF24_TRACE_SIZE transactions. The Pico timestamps with the
+// 1 MHz timer and measures durations in CPU cycles with SysTick, a free-running
+// 24-bit down-counter. SysTick is per core, so it is started on whichever core
+// traces first, unless that core already runs it. Host builds use the transport
+// clock for both. Transactions from the IRQ, hop and DMA paths record too, so a slot
+// is reserved and filled with interrupts held off.
+class NRF24_Tracer
+{
+private:
+    NRF24_TraceEntry entries[NRF24_TRACE_SIZE];
+    uint32_t total;          // Entries ever recorded
+    NRF24_Transport *transport;
+    
+    static_assert((NRF24_TRACE_SIZE & (NRF24_TRACE_SIZE - 1)) == 0, "NRF24_TRACE_SIZE must be a power of two");
+    
+    uint32_t nowUs()
+    {
+#if NRF24_PICO
+        return time_us_32();
+#else
+        return transport->micros();
+#endif
+    }
+    
+    uint32_t ticks()
+    {
+#if NRF24_PICO
+        if (!(systick_hw->csr & 0x1)) {
+            systick_hw->rvr = 0x00FFFFFF;
+            systick_hw->cvr = 0;
+            systick_hw->csr = 0x5;  // Enabled, processor clock, no interrupt
+        }
+        return systick_hw->cvr;
+#else
+        return transport->micros();
+#endif
+    }
+    
+    static void put16(uint8_t *p, uint16_t v) { p[0] = v; p[1] = v >> 8; }
+    static void put32(uint8_t *p, uint32_t v) { put16(p, v); put16(p + 2, v >> 16); }
+
+public:
+    void begin(NRF24_Transport *transport)
+    {
+        this->transport = transport;
+        total = 0;
+    }
+    
+    uint32_t tickHz()
+    {
+#if NRF24_PICO
+        return clock_get_hz(clk_sys);
+#else
+        return 1000000;
+#endif
+    }
+    
+    NRF24_TraceMark mark()
+    {
+        NRF24_TraceMark m;
+        m.start_us = nowUs();
+        m.start_ticks = ticks();
+        return m;
+    }
+    
+    void record(const NRF24_TraceMark &m, uint8_t cmd, uint8_t len)
+    {
+#if NRF24_PICO
+        uint32_t elapsed = (m.start_ticks - ticks()) & 0x00FFFFFF;  // SysTick counts down
+#else
+        uint32_t elapsed = ticks() - m.start_ticks;
+#endif
+        uint32_t irq_state = transport->enterCritical();
+        NRF24_TraceEntry *e = &entries[total++ & (NRF24_TRACE_SIZE - 1)];
+        e->start_us = m.start_us;
+        e->duration = elapsed > 0xFFFF ? 0xFFFF : elapsed;
+        e->cmd = cmd;
+        e->len = len;
+        transport->exitCritical(irq_state);
+    }
+    
+    void clear() { total = 0; }
+    uint32_t getTotal() { return total; }
+    uint16_t count() { return total < NRF24_TRACE_SIZE ? total : NRF24_TRACE_SIZE; }
+    
+    // Little-endian dump, oldest entry first:
+    //   u16 magic, u8 version, u8 entry size, u32 tick Hz, u32 total recorded,
+    //   u16 entries that follow, u16 reserved; then per entry
+    //   u32 start_us, u16 duration, u8 cmd, u8 len.
+    // Only whole entries are written; returns the number of bytes used.
+    uint32_t dump(uint8_t *buffer, uint32_t size)
+    {
+        if (size < NRF24_TRACE_HEADER_SIZE) return 0;
+        
+        uint32_t n = count();
+        uint32_t room = (size - NRF24_TRACE_HEADER_SIZE) / NRF24_TRACE_ENTRY_SIZE;
+        uint32_t skip = n > room ? n - room : 0;  // Keep the newest entries
+        n -= skip;
+        
+        put16(buffer, NRF24_TRACE_MAGIC);
+        buffer[2] = NRF24_TRACE_VERSION;
+        buffer[3] = NRF24_TRACE_ENTRY_SIZE;
+        put32(buffer + 4, tickHz());
+        put32(buffer + 8, total);
+        put16(buffer + 12, n);
+        put16(buffer + 14, 0);
+        
+        uint8_t *p = buffer + NRF24_TRACE_HEADER_SIZE;
+        for (uint32_t seq = total - n; seq != total; seq++) {
+            NRF24_TraceEntry *e = &entries[seq & (NRF24_TRACE_SIZE - 1)];
+            put32(p, e->start_us);
+            put16(p + 4, e->duration);
+            p[6] = e->cmd;
+            p[7] = e->len;
+            p += NRF24_TRACE_ENTRY_SIZE;
+        }
+        return p - buffer;
+    }
+};
+
+#define NRF24_TRACE_BEGIN(tracer)               NRF24_TraceMark trace_mark = (tracer).mark()
+#define NRF24_TRACE_END(tracer, cmd, len)       (tracer).record(trace_mark, cmd, len)
+
+#else
+
+#define NRF24_TRACE_BEGIN(tracer)
+#define NRF24_TRACE_END(tracer, cmd, len)
+
+#endif
+
+#endif
@@ -0,0 +1,84 @@
+
+#ifndef __NRF24_TRANSPORT_H_
+#define __NRF24_TRANSPORT_H_
+
+#include <stdint.h>
+#include <stddef.h>
+
+// Platform selection: the Pico SDK unless NRF24_HOST is defined
+#ifdef NRF24_HOST
+#define NRF24_PICO                  0
+#else
+#define NRF24_PICO                  1
+#endif
+
+#if NRF24_PICO
+#include "hardware/sync.h"
+#define NRF24_MEMORY_BARRIER()      __dmb()
+#else
+#define NRF24_MEMORY_BARRIER()      __sync_synchronize()
+#endif
+
+typedef void (*NRF24_IrqHandler)(void *context);
+typedef void (*NRF24_TransferCallback)(void *context, uint8_t status);
+
+// Everything the driver needs from the platform: nRF24 SPI transactions, the CE
+// line, the IRQ line and time. One transport instance serves one radio.
+class NRF24_Transport
+{
+protected:
+    NRF24_TransferCallback transfer_callback;
+    void *transfer_context;
+
+public:
+    NRF24_Transport() : transfer_callback(NULL), transfer_context(NULL) {}
+    virtual ~NRF24_Transport() {}
+    
+    // Bring up the bus and pins at a conservative speed
+    virtual bool begin() = 0;
+    virtual void setSpeed(uint32_t hz) { (void)hz; }
+    
+    // One complete transaction: CSN low, cmd out / STATUS in, then len bytes
+    // written from tx or read into rx, CSN high. Returns STATUS.
+    virtual uint8_t transfer(uint8_t cmd, const uint8_t *tx, uint8_t *rx, uint8_t len) = 0;
+    virtual void setCE(bool high) = 0;
+    
+    // Optional CE pulse timed by the transport, queued behind the transactions
+    // already issued. Returns false when the caller should time the pulse itself.
+    virtual bool pulseCE(uint32_t us) { (void)us; return false; }
+    
+    // Timing
+    virtual void delayUs(uint32_t us) = 0;
+    virtual uint32_t micros() = 0;
+    
+    // IRQ line (active low). attachInterrupt() returns false if no IRQ is wired.
+    virtual bool attachInterrupt(NRF24_IrqHandler handler, void *context) { (void)handler; (void)context; return false; }
+    virtual void detachInterrupt() {}
+    virtual bool isIrqAsserted() { return false; }
+    
+    // Keep the IRQ handler (and async completions) out of a critical section
+    virtual uint32_t enterCritical() { return 0; }
+    virtual void exitCritical(uint32_t state) { (void)state; }
+    
+    // Optional asynchronous transfers (DMA on the Pico). startTransfer() returns false
+    // when this transfer cannot run asynchronously and the caller should use transfer().
+    // On completion the transfer callback receives STATUS; rx is filled before that.
+    virtual bool enableDMA() { return false; }
+    virtual void disableDMA() {}
+    virtual bool isDMAEnabled() { return false; }
+    virtual bool startTransfer(uint8_t cmd, const uint8_t *tx, uint8_t *rx, uint8_t len)
+    {
+        (void)cmd; (void)tx; (void)rx; (void)len;
+        return false;
+    }
+    virtual bool isTransferPending() { return false; }
+    virtual void waitTransfer() {}
+    
+    void setTransferCallback(NRF24_TransferCallback callback, void *context)
+    {
+        transfer_callback = callback;
+        transfer_context = context;
+    }
+};
+
+#endif
@@ -0,0 +1,264 @@
+#include "NRF24_Bench.h"
+#include <stdio.h>
+#include <string.h>
+
+static uint8_t bench_forward[5] = {0xB1, 0xE7, 0xC4, 0x01, 0x01};   // tx to rx
+static uint8_t bench_back[5] = {0xB1, 0xE7, 0xC4, 0x01, 0x02};      // rx to tx (latency echo)
+
+static const char *bench_mode_names[] = {"write", "write_noack", "start_write", "dynamic", "ack_payload"};
+
+#define NRF24_BENCH_WAIT_US         20000  // Give up on a packet or echo after this
+
+static uint16_t benchRateKbps(NRF24_DataRate rate)
+{
+    switch (rate) {
+        case NRF24_DATA_RATE_2MBPS: return 2000;
+        case NRF24_DATA_RATE_250KBPS: return 250;
+        default: return 1000;
+    }
+}
+
+// Constructor
+NRF24_Bench::NRF24_Bench(NRF24 *tx, NRF24 *rx)
+{
+    this->tx = tx;
+    this->rx = rx;
+    this->clock = tx->getTransport();
+    this->packets = NRF24_BENCH_PACKETS;
+    this->samples = NRF24_BENCH_SAMPLES;
+}
+
+void NRF24_Bench::setPackets(uint16_t packets)
+{
+    this->packets = packets;
+}
+
+void NRF24_Bench::setSamples(uint16_t samples)
+{
+    this->samples = samples > NRF24_BENCH_SAMPLES ? NRF24_BENCH_SAMPLES : samples;
+}
+
+void NRF24_Bench::configure(NRF24 *radio, NRF24_BenchMode mode, NRF24_DataRate rate, uint8_t payload)
+{
+    bool dynamic = (mode == NRF24_BENCH_DYNAMIC || mode == NRF24_BENCH_ACK_PAYLOAD);
+    
+    radio->stopListening();
+    radio->setChannel(NRF24_BENCH_CHANNEL);
+    radio->setDataRate(rate);
+    radio->setCRCLength(NRF24_CRC_16BIT);
+    
+    // Long enough for a full ACK payload to come back at every rate
+    radio->setRetries(rate == NRF24_DATA_RATE_250KBPS ? NRF24_ARD_1500US : NRF24_ARD_500US, 5);
+    radio->setAutoAck(mode != NRF24_BENCH_WRITE_NOACK);
+    
+    if (dynamic) {
+        radio->enableDynamicPayloads();
+    } else {
+        radio->disableDynamicPayloads();
+    }
+    if (mode == NRF24_BENCH_ACK_PAYLOAD) {
+        radio->enableAckPayload();
+    } else {
+        radio->disableAckPayload();
+    }
+    
+    if (radio == tx) {
+        radio->openWritingPipe(bench_forward);
+        radio->openReadingPipe(1, bench_back);
+    } else {
+        radio->openWritingPipe(bench_back);
+        radio->openReadingPipe(1, bench_forward);
+    }
+    radio->setPayloadSize(payload);
+    radio->flushTxFifo();
+    radio->flushRxFifo();
+    radio->clearInterrupt(NRF_STATUS_RX_DR | NRF_STATUS_TX_DS | NRF_STATUS_MAX_RT);
+}
+
+// Read everything the radio has queued, timing the read path
+uint32_t NRF24_Bench::drain(NRF24 *radio, uint8_t payload, uint32_t *read_us)
+{
+    uint8_t buffer[NRF_MAX_PAYLOAD_SIZE];
+    uint32_t count = 0;
+    uint32_t start = clock->micros();
+    while (radio->available()) {
+        radio->read(buffer, payload);
+        count++;
+    }
+    if (read_us) {
+        *read_us += clock->micros() - start;
+    }
+    return count;
+}
+
+void NRF24_Bench::runThroughput(NRF24_BenchMode mode, NRF24_DataRate rate, uint8_t payload, NRF24_BenchResult *result)
+{
+    uint8_t data[NRF_MAX_PAYLOAD_SIZE];
+    memset(data, 0xA5, sizeof(data));
+    memset(result, 0, sizeof(NRF24_BenchResult));
+    result->mode = mode;
+    result->rate = rate;
+    result->payload = payload;
+    
+    configure(tx, mode, rate, payload);
+    configure(rx, mode, rate, payload);
+    rx->startListening();
+    if (mode == NRF24_BENCH_ACK_PAYLOAD) {
+        rx->writeAckPayload(1, data, payload);
+    }
+    
+    uint32_t start = clock->micros();
+    for (uint16_t i = 0; i < packets; i++) {
+        data[0] = i;
+        bool ok;
+        if (mode == NRF24_BENCH_START_WRITE) {
+            tx->startWrite(data, payload);
+            uint32_t sent = clock->micros();
+            uint8_t flags;
+            while (!(flags = tx->getStatus() & (NRF_STATUS_TX_DS | NRF_STATUS_MAX_RT))) {
+                if (clock->micros() - sent > NRF24_BENCH_WAIT_US) break;
+            }
+            tx->clearInterrupt(NRF_STATUS_TX_DS | NRF_STATUS_MAX_RT);
+            ok = (flags & NRF_STATUS_TX_DS) != 0;
+            if (!ok) tx->flushTxFifo();
+        } else {
+            ok = tx->write(data, payload);
+        }
+        result->packets++;
+        if (ok) result->acked++;
+        
+        uint32_t got = drain(rx, payload, &result->read_us);
+        result->delivered += got;
+        if (mode == NRF24_BENCH_ACK_PAYLOAD) {
+            drain(tx, payload, NULL);
+            while (got--) {
+                rx->writeAckPayload(1, data, payload);
+            }
+        }
+    }
+    result->elapsed_us = clock->micros() - start;
+    
+    rx->stopListening();
+    rx->flushTxFifo();
+}
+
+// Ping-pong: tx sends, rx reads and echoes the payload back, tx reads the echo
+void NRF24_Bench::runLatency(NRF24_DataRate rate, uint8_t payload, NRF24_LatencyResult *result)
+{
+    uint8_t data[NRF_MAX_PAYLOAD_SIZE];
+    uint8_t echo[NRF_MAX_PAYLOAD_SIZE];
+    memset(data, 0x5A, sizeof(data));
+    memset(result, 0, sizeof(NRF24_LatencyResult));
+    result->rate = rate;
+    result->payload = payload;
+    
+    configure(tx, NRF24_BENCH_WRITE, rate, payload);
+    configure(rx, NRF24_BENCH_WRITE, rate, payload);
+    rx->startListening();
+    
+    uint16_t count = 0;
+    for (uint16_t i = 0; i < samples; i++) {
+        data[0] = i;
+        uint32_t start = clock->micros();
+        if (!tx->write(data, payload)) continue;
+        tx->startListening();
+        
+        // Echo from the other side
+        while (!rx->available()) {
+            if (clock->micros() - start > NRF24_BENCH_WAIT_US) break;
+        }
+        bool echoed = false;
+        if (rx->available()) {
+            rx->read(echo, payload);
+            rx->stopListening();
+            echoed = rx->write(echo, payload);
+            rx->startListening();
+        }
+        
+        bool back = false;
+        while (echoed && !back) {
+            back = tx->available();
+            if (clock->micros() - start > NRF24_BENCH_WAIT_US) break;
+        }
+        if (back) {
+            tx->read(echo, payload);
+            latency[count++] = clock->micros() - start;
+        }
+        tx->stopListening();
+    }
+    rx->stopListening();
+    
+    result->samples = count;
+    if (count) {
+        result->p50_us = percentile(count, 50);
+        result->p90_us = percentile(count, 90);
+        result->p99_us = percentile(count, 99);
+        result->max_us = percentile(count, 100);
+    }
+}
+
+uint32_t NRF24_Bench::percentile(uint16_t count, uint8_t percent)
+{
+    // Insertion sort; sample counts are small
+    for (uint16_t i = 1; i < count; i++) {
+        uint32_t v = latency[i];
+        uint16_t j = i;
+        while (j > 0 && latency[j - 1] > v) {
+            latency[j] = latency[j - 1];
+            j--;
+        }
+        latency[j] = v;
+    }
+    return latency[(uint32_t)(count - 1) * percent / 100];
+}
+
+void NRF24_Bench::runAll()
+{
+    static const NRF24_DataRate rates[] = {NRF24_DATA_RATE_2MBPS, NRF24_DATA_RATE_1MBPS, NRF24_DATA_RATE_250KBPS};
+    static const uint8_t sizes[] = {1, 8, 16, 32};
+    
+    printHeader();
+    for (uint8_t m = NRF24_BENCH_WRITE; m <= NRF24_BENCH_ACK_PAYLOAD; m++) {
+        for (uint8_t r = 0; r < 3; r++) {
+            for (uint8_t s = 0; s < 4; s++) {
+                NRF24_BenchResult result;
+                runThroughput((NRF24_BenchMode)m, rates[r], sizes[s], &result);
+                print(&result);
+            }
+        }
+    }
+    for (uint8_t r = 0; r < 3; r++) {
+        for (uint8_t s = 0; s < 4; s++) {
+            NRF24_LatencyResult result;
+            runLatency(rates[r], sizes[s], &result);
+            print(&result);
+        }
+    }
+}
+
+void NRF24_Bench::printHeader()
+{
+    printf("#throughput,mode,rate_kbps,payload,packets,acked,delivered,elapsed_us,pps,goodput_kbps,read_us_per_packet\n");
+    printf("#latency,rate_kbps,payload,samples,p50_us,p90_us,p99_us,max_us\n");
+}
+
+void NRF24_Bench::print(const NRF24_BenchResult *result)
+{
+    uint32_t elapsed = result->elapsed_us ? result->elapsed_us : 1;
+    uint32_t pps = (uint64_t)result->delivered * 1000000 / elapsed;
+    uint32_t goodput = (uint64_t)result->delivered * result->payload * 8000 / elapsed;
+    uint32_t read_us = result->delivered ? result->read_us / result->delivered : 0;
+    
+    printf("throughput,%s,%u,%u,%lu,%lu,%lu,%lu,%lu,%lu,%lu\n",
+           bench_mode_names[result->mode], benchRateKbps(result->rate), result->payload,
+           (unsigned long)result->packets, (unsigned long)result->acked, (unsigned long)result->delivered,
+           (unsigned long)result->elapsed_us, (unsigned long)pps, (unsigned long)goodput, (unsigned long)read_us);
+}
+
+void NRF24_Bench::print(const NRF24_LatencyResult *result)
+{
+    printf("latency,%u,%u,%u,%lu,%lu,%lu,%lu\n",
+           benchRateKbps(result->rate), result->payload, result->samples,
+           (unsigned long)result->p50_us, (unsigned long)result->p90_us,
+           (unsigned long)result->p99_us, (unsigned long)result->max_us);
+}
@@ -0,0 +1,75 @@
+
+#ifndef __NRF24_BENCH_H_
+#define __NRF24_BENCH_H_
+
+#include "NRF24.h"
+
+#define NRF24_BENCH_PACKETS         500   // Packets per throughput run
+#define NRF24_BENCH_SAMPLES         200   // Round trips per latency run
+#define NRF24_BENCH_CHANNEL         76
+
+// What a throughput run exercises on the transmitting radio
+enum NRF24_BenchMode {
+    NRF24_BENCH_WRITE = 0,          // write(), auto-ack
+    NRF24_BENCH_WRITE_NOACK = 1,    // write(), auto-ack off on both radios
+    NRF24_BENCH_START_WRITE = 2,    // startWrite(), STATUS polled for the outcome
+    NRF24_BENCH_DYNAMIC = 3,        // write() with dynamic payloads
+    NRF24_BENCH_ACK_PAYLOAD = 4     // write() with an ACK payload of the same size coming back
+};
+
+typedef struct {
+    NRF24_BenchMode mode;
+    NRF24_DataRate rate;
+    uint8_t payload;
+    uint32_t packets;
+    uint32_t acked;         // TX_DS on the transmitter
+    uint32_t delivered;     // Payloads read() on the receiver
+    uint32_t elapsed_us;
+    uint32_t read_us;       // Receiver time spent in available() + read()
+} NRF24_BenchResult;
+
+typedef struct {
+    NRF24_DataRate rate;
+    uint8_t payload;
+    uint16_t samples;       // Completed round trips
+    uint32_t p50_us;
+    uint32_t p90_us;
+    uint32_t p99_us;
+    uint32_t max_us;
+} NRF24_LatencyResult;
+
+// Benchmarks between two radios driven by the same program: two modules on the
+// Pico's two SPI buses, or two simulated radios on a shared host clock. Results are
+// printed as CSV, one "throughput" or "latency" row per run.
+class NRF24_Bench
+{
+private:
+    NRF24 *tx;
+    NRF24 *rx;
+    NRF24_Transport *clock;
+    uint16_t packets;
+    uint16_t samples;
+    uint32_t latency[NRF24_BENCH_SAMPLES];
+    
+    void configure(NRF24 *radio, NRF24_BenchMode mode, NRF24_DataRate rate, uint8_t payload);
+    uint32_t drain(NRF24 *radio, uint8_t payload, uint32_t *read_us);
+    uint32_t percentile(uint16_t count, uint8_t percent);
+
+public:
+    NRF24_Bench(NRF24 *tx, NRF24 *rx);
+    
+    void setPackets(uint16_t packets);
+    void setSamples(uint16_t samples);
+    
+    void runThroughput(NRF24_BenchMode mode, NRF24_DataRate rate, uint8_t payload, NRF24_BenchResult *result);
+    void runLatency(NRF24_DataRate rate, uint8_t payload, NRF24_LatencyResult *result);
+    
+    // Every mode, data rate and payload size in {1, 8, 16, 32}, then latency
+    void runAll();
+    
+    static void printHeader();
+    static void print(const NRF24_BenchResult *result);
+    static void print(const NRF24_LatencyResult *result);
+};
+
+#endif
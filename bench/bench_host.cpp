@@ -0,0 +1,29 @@
+// Host benchmark: two simulated radios on a shared virtual clock. Timing is
+// deterministic, so runs can be diffed to catch driver regressions.
+#include "NRF24_Simulator.h"
+#include "NRF24_Bench.h"
+#include <stdio.h>
+#include <stdlib.h>
+
+int main(int argc, char **argv)
+{
+    NRF24_SimAir air;
+    NRF24_SimRadio radio_tx(&air), radio_rx(&air);
+    NRF24_HostTransport transport_tx(&radio_tx, air.clock());
+    NRF24_HostTransport transport_rx(&radio_rx, air.clock());
+    NRF24 tx(&transport_tx), rx(&transport_rx);
+    
+    // Optional packet loss in percent, to benchmark the retry paths
+    if (argc > 1) {
+        air.setPacketLoss(atoi(argv[1]));
+    }
+    
+    if (!tx.begin() || !rx.begin()) {
+        printf("begin failed\n");
+        return 1;
+    }
+    
+    NRF24_Bench bench(&tx, &rx);
+    bench.runAll();
+    return 0;
+}
@@ -0,0 +1,25 @@
+// On-target benchmark: two modules on one Pico, one per SPI bus.
+// TX radio: spi0, SCK 2, MOSI 3, MISO 4, CSN 5, CE 6, IRQ 7
+// RX radio: spi1, SCK 10, MOSI 11, MISO 12, CSN 13, CE 14, IRQ 15
+#include "pico/stdlib.h"
+#include "NRF24.h"
+#include "NRF24_Bench.h"
+#include <stdio.h>
+
+int main()
+{
+    stdio_init_all();
+    sleep_ms(2000); // Time to open the serial console
+    
+    NRF24 tx(spi0, 2, 3, 4, 5, 6, 7);
+    NRF24 rx(spi1, 10, 11, 12, 13, 14, 15);
+    if (!tx.begin() || !rx.begin()) {
+        printf("begin failed\n");
+        while (true) tight_loop_contents();
+    }
+    
+    NRF24_Bench bench(&tx, &rx);
+    bench.runAll();
+    
+    while (true) tight_loop_contents();
+}
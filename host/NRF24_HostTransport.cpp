@@ -0,0 +1,311 @@
+#include "NRF24_HostTransport.h"
+#include <string.h>
+
+// Transports on a shared clock. Each one stands for a separate MCU, so its IRQ
+// handler may run whenever any of them moves time forward.
+static NRF24_HostTransport *shared_transports[NRF24_HOST_MAX_SHARED];
+
+// Constructor and destructor
+NRF24_HostTransport::NRF24_HostTransport(NRF24_HostDevice *device, uint64_t *shared_clock_ns)
+{
+    this->device = device;
+    this->local_ns = 0;
+    this->now_ns = shared_clock_ns ? shared_clock_ns : &local_ns;
+    this->speed_hz = 4000000;
+    this->irq_handler = NULL;
+    this->irq_context = NULL;
+    this->irq_level = false;
+    this->irq_pending = false;
+    this->irq_running = false;
+    this->critical_depth = 0;
+    memset(&counters, 0, sizeof(counters));
+    
+    if (shared_clock_ns) {
+        for (int i = 0; i < NRF24_HOST_MAX_SHARED; i++) {
+            if (!shared_transports[i]) {
+                shared_transports[i] = this;
+                break;
+            }
+        }
+    }
+}
+
+NRF24_HostTransport::~NRF24_HostTransport()
+{
+    for (int i = 0; i < NRF24_HOST_MAX_SHARED; i++) {
+        if (shared_transports[i] == this) {
+            shared_transports[i] = NULL;
+        }
+    }
+}
+
+bool NRF24_HostTransport::begin()
+{
+    speed_hz = 4000000;
+    return device != NULL;
+}
+
+void NRF24_HostTransport::setSpeed(uint32_t hz)
+{
+    if (hz) {
+        speed_hz = hz;
+    }
+}
+
+uint8_t NRF24_HostTransport::transfer(uint8_t cmd, const uint8_t *tx, uint8_t *rx, uint8_t len)
+{
+    uint8_t status = device->transfer(cmd, tx, rx, len);
+    
+    // Classify by opcode
+    counters.transactions++;
+    counters.bytes += len + 1;
+    if (cmd <= 0x1F) {
+        counters.reg_reads++;
+    } else if (cmd <= 0x3F) {
+        counters.reg_writes++;
+    } else if (cmd == NRF_R_RX_PAYLOAD || cmd == NRF_W_TX_PAYLOAD || cmd == NRF_W_TX_PAYLOAD_NO_ACK ||
+               (cmd & 0xF8) == NRF_W_ACK_PAYLOAD) {
+        counters.payload_ops++;
+    } else {
+        counters.commands++;
+    }
+    
+    uint64_t bus_ns = (uint64_t)(len + 1) * 8 * 1000000000ULL / speed_hz;
+    counters.bus_time_ns += bus_ns;
+    advance(bus_ns);
+    return status;
+}
+
+void NRF24_HostTransport::setCE(bool high)
+{
+    device->setCE(high);
+    pollIrq();
+}
+
+// Timing
+void NRF24_HostTransport::delayUs(uint32_t us)
+{
+    advance((uint64_t)us * 1000);
+}
+
+uint32_t NRF24_HostTransport::micros()
+{
+    return (uint32_t)(*now_ns / 1000);
+}
+
+void NRF24_HostTransport::advance(uint64_t ns)
+{
+    *now_ns += ns;
+    device->advance(micros());
+    pollIrq();
+    
+    for (int i = 0; i < NRF24_HOST_MAX_SHARED; i++) {
+        NRF24_HostTransport *other = shared_transports[i];
+        if (other && other != this && other->now_ns == now_ns) {
+            other->pollIrq();
+        }
+    }
+}
+
+// IRQ line
+void NRF24_HostTransport::pollIrq()
+{
+    bool level = device->irqAsserted();
+    if (level && !irq_level) {
+        irq_pending = true;
+    }
+    irq_level = level;
+    
+    // Like a latched GPIO edge: delivered once the handler may run
+    while (irq_pending && irq_handler && !irq_running && critical_depth == 0) {
+        irq_pending = false;
+        irq_running = true;
+        irq_handler(irq_context);
+        irq_running = false;
+    }
+}
+
+void NRF24_HostTransport::poll()
+{
+    advance(0);
+}
+
+bool NRF24_HostTransport::attachInterrupt(NRF24_IrqHandler handler, void *context)
+{
+    irq_handler = handler;
+    irq_context = context;
+    irq_level = device->irqAsserted();
+    irq_pending = false;
+    return true;
+}
+
+void NRF24_HostTransport::detachInterrupt()
+{
+    irq_handler = NULL;
+    irq_context = NULL;
+    irq_pending = false;
+}
+
+bool NRF24_HostTransport::isIrqAsserted()
+{
+    return device->irqAsserted();
+}
+
+uint32_t NRF24_HostTransport::enterCritical()
+{
+    critical_depth++;
+    return 0;
+}
+
+void NRF24_HostTransport::exitCritical(uint32_t state)
+{
+    (void)state;
+    if (critical_depth && --critical_depth == 0) {
+        pollIrq();
+    }
+}
+
+// SPI transaction counters
+void NRF24_HostTransport::getCounters(NRF24_HostCounters *counters)
+{
+    *counters = this->counters;
+}
+
+void NRF24_HostTransport::resetCounters()
+{
+    memset(&counters, 0, sizeof(counters));
+}
+
+// Stub device
+NRF24_StubDevice::NRF24_StubDevice()
+{
+    reset();
+}
+
+// Datasheet reset values
+void NRF24_StubDevice::reset()
+{
+    memset(regs, 0, sizeof(regs));
+    regs[NRF_CONFIG_REGISTER] = 0x08;
+    regs[NRF_EN_AA_REGISTER] = 0x3F;
+    regs[NRF_EN_RXADDR_REGISTER] = 0x03;
+    regs[NRF_SETUP_AW_REGISTER] = 0x03;
+    regs[NRF_SETUP_RETR_REGISTER] = 0x03;
+    regs[NRF_RF_CH_REGISTER] = 0x02;
+    regs[NRF_RF_SETUP_REGISTER] = 0x0E;
+    regs[NRF_STATUS_REGISTER] = 0x0E;
+    regs[NRF_RX_ADDR_P2_REGISTER] = 0xC3;
+    regs[NRF_RX_ADDR_P3_REGISTER] = 0xC4;
+    regs[NRF_RX_ADDR_P4_REGISTER] = 0xC5;
+    regs[NRF_RX_ADDR_P5_REGISTER] = 0xC6;
+    regs[NRF_FIFO_STATUS_REGISTER] = NRF_FIFO_STATUS_TX_EMPTY | NRF_FIFO_STATUS_RX_EMPTY;
+    
+    memset(addr[0], 0xE7, NRF_MAX_ADDR_SIZE);
+    memset(addr[1], 0xC2, NRF_MAX_ADDR_SIZE);
+    memset(addr[6], 0xE7, NRF_MAX_ADDR_SIZE);
+    for (int i = 2; i < 6; i++) {
+        memset(addr[i], 0xC2, NRF_MAX_ADDR_SIZE);
+        addr[i][0] = regs[NRF_RX_ADDR_P0_REGISTER + i];
+    }
+    tx_count = 0;
+    ce = false;
+}
+
+uint8_t NRF24_StubDevice::statusByte()
+{
+    uint8_t status = regs[NRF_STATUS_REGISTER] & (NRF_STATUS_RX_DR | NRF_STATUS_TX_DS | NRF_STATUS_MAX_RT);
+    status |= NRF_STATUS_RX_P_NO; // RX FIFO always empty
+    if (tx_count >= NRF_TX_FIFO_DEPTH) {
+        status |= NRF_STATUS_TX_FULL;
+    }
+    return status;
+}
+
+void NRF24_StubDevice::updateFifoStatus()
+{
+    uint8_t fifo = NRF_FIFO_STATUS_RX_EMPTY;
+    if (tx_count == 0) fifo |= NRF_FIFO_STATUS_TX_EMPTY;
+    if (tx_count >= NRF_TX_FIFO_DEPTH) fifo |= NRF_FIFO_STATUS_TX_FULL;
+    regs[NRF_FIFO_STATUS_REGISTER] = fifo;
+    regs[NRF_STATUS_REGISTER] = statusByte();
+}
+
+// Every queued packet is "acknowledged" as soon as the PTX is allowed to send
+void NRF24_StubDevice::transmit()
+{
+    uint8_t config = regs[NRF_CONFIG_REGISTER];
+    if (!ce || !(config & NRF_CONFIG_PWR_UP) || (config & NRF_CONFIG_PRIM_RX) || tx_count == 0) return;
+    
+    tx_count = 0;
+    regs[NRF_STATUS_REGISTER] |= NRF_STATUS_TX_DS;
+    updateFifoStatus();
+}
+
+uint8_t NRF24_StubDevice::transfer(uint8_t cmd, const uint8_t *tx, uint8_t *rx, uint8_t len)
+{
+    uint8_t status = statusByte();
+    
+    if (cmd <= 0x3F) {
+        uint8_t reg = cmd & 0x1F;
+        bool is_addr = (reg >= NRF_RX_ADDR_P0_REGISTER && reg <= NRF_TX_ADDR_REGISTER);
+        uint8_t *target = is_addr ? addr[reg - NRF_RX_ADDR_P0_REGISTER] : NULL;
+        
+        for (uint8_t i = 0; i < len; i++) {
+            if (cmd & NRF_W_REGISTER) {
+                if (reg == NRF_STATUS_REGISTER) {
+                    // Write 1 to clear
+                    regs[reg] &= ~(tx[i] & (NRF_STATUS_RX_DR | NRF_STATUS_TX_DS | NRF_STATUS_MAX_RT));
+                } else if (target && i < NRF_MAX_ADDR_SIZE) {
+                    target[i] = tx[i];
+                    if (i == 0) regs[reg] = tx[i];
+                } else if (i == 0 && reg <= NRF_FEATURE_REGISTER && reg != NRF_FIFO_STATUS_REGISTER) {
+                    regs[reg] = tx[i];
+                }
+            } else if (rx) {
+                if (target && i < NRF_MAX_ADDR_SIZE) {
+                    rx[i] = target[i];
+                } else {
+                    rx[i] = (i == 0 && reg <= NRF_FEATURE_REGISTER) ? regs[reg] : 0;
+                }
+            }
+        }
+        updateFifoStatus();
+        transmit();
+        return status;
+    }
+    
+    switch (cmd) {
+        case NRF_W_TX_PAYLOAD:
+        case NRF_W_TX_PAYLOAD_NO_ACK:
+            if (tx_count < NRF_TX_FIFO_DEPTH) {
+                tx_count++;
+            }
+            updateFifoStatus();
+            transmit();
+            break;
+        case NRF_FLUSH_TX:
+            tx_count = 0;
+            updateFifoStatus();
+            break;
+        default:
+            // Reads (payloads, R_RX_PL_WID) return zeros; everything else is a no-op
+            if (rx) {
+                memset(rx, 0, len);
+            }
+            break;
+    }
+    return status;
+}
+
+void NRF24_StubDevice::setCE(bool high)
+{
+    ce = high;
+    transmit();
+}
+
+bool NRF24_StubDevice::irqAsserted()
+{
+    uint8_t flags = regs[NRF_STATUS_REGISTER] & (NRF_STATUS_RX_DR | NRF_STATUS_TX_DS | NRF_STATUS_MAX_RT);
+    uint8_t masked = regs[NRF_CONFIG_REGISTER] & (NRF_CONFIG_MASK_RX_DR | NRF_CONFIG_MASK_TX_DS | NRF_CONFIG_MASK_MAX_RT);
+    return (flags & ~masked) != 0;
+}
@@ -0,0 +1,114 @@
+
+#ifndef __NRF24_HOSTTRANSPORT_H_
+#define __NRF24_HOSTTRANSPORT_H_
+
+#ifndef NRF24_HOST
+#error "The host transport is only built with -DNRF24_HOST"
+#endif
+
+#include "NRF24.h"
+
+// Transports that can share one clock (one per simulated radio)
+#define NRF24_HOST_MAX_SHARED       8
+
+// Something on the far side of the SPI bus: a stub, a simulator or a USB bridge
+class NRF24_HostDevice
+{
+public:
+    virtual ~NRF24_HostDevice() {}
+    
+    // One complete CSN-low transaction, same contract as NRF24_Transport::transfer()
+    virtual uint8_t transfer(uint8_t cmd, const uint8_t *tx, uint8_t *rx, uint8_t len) = 0;
+    virtual void setCE(bool high) = 0;
+    
+    // Let the device run up to now_us on the transport's virtual clock
+    virtual void advance(uint32_t now_us) { (void)now_us; }
+    virtual bool irqAsserted() { return false; }
+};
+
+// SPI traffic seen by the host transport since the last reset
+typedef struct {
+    uint32_t transactions;
+    uint32_t bytes;           // Including command bytes
+    uint32_t reg_reads;
+    uint32_t reg_writes;
+    uint32_t payload_ops;     // R_RX_PAYLOAD, W_TX_PAYLOAD(_NO_ACK), W_ACK_PAYLOAD
+    uint32_t commands;        // Everything else (NOP, flushes, R_RX_PL_WID...)
+    uint64_t bus_time_ns;     // Time spent clocking bytes at the configured speed
+} NRF24_HostCounters;
+
+// Runs the driver on a desktop machine against an NRF24_HostDevice. Time is virtual:
+// it advances only by SPI byte time and delayUs(), so runs are deterministic.
+// Transports of radios that share one simulation must share one clock; IRQ handlers
+// of all of them then run as time advances, as if each radio had its own MCU.
+// The IRQ line is sampled at transaction and delay boundaries; a falling edge calls
+// the attached handler unless a critical section or the handler itself is active.
+class NRF24_HostTransport : public NRF24_Transport
+{
+private:
+    NRF24_HostDevice *device;
+    uint64_t local_ns;
+    uint64_t *now_ns;        // local_ns, or a clock shared with other transports
+    uint32_t speed_hz;
+    NRF24_HostCounters counters;
+    
+    NRF24_IrqHandler irq_handler;
+    void *irq_context;
+    bool irq_level;
+    bool irq_pending;
+    bool irq_running;
+    uint32_t critical_depth;
+    
+    void advance(uint64_t ns);
+    void pollIrq();
+
+public:
+    NRF24_HostTransport(NRF24_HostDevice *device, uint64_t *shared_clock_ns = NULL);
+    ~NRF24_HostTransport();
+    
+    bool begin();
+    void setSpeed(uint32_t hz);
+    uint8_t transfer(uint8_t cmd, const uint8_t *tx, uint8_t *rx, uint8_t len);
+    void setCE(bool high);
+    
+    void delayUs(uint32_t us);
+    uint32_t micros();
+    
+    bool attachInterrupt(NRF24_IrqHandler handler, void *context);
+    void detachInterrupt();
+    bool isIrqAsserted();
+    uint32_t enterCritical();
+    void exitCritical(uint32_t state);
+    
+    // Deliver a pending IRQ edge now
+    void poll();
+    
+    // SPI transaction counters
+    void getCounters(NRF24_HostCounters *counters);
+    void resetCounters();
+};
+
+// Minimal register-file device: enough for begin() and configuration to succeed.
+// A CE pulse with a loaded TX FIFO completes at once with TX_DS; nothing is received.
+class NRF24_StubDevice : public NRF24_HostDevice
+{
+private:
+    uint8_t regs[NRF_FEATURE_REGISTER + 1];
+    uint8_t addr[7][NRF_MAX_ADDR_SIZE];  // RX_ADDR_P0..P5, TX_ADDR
+    uint8_t tx_count;
+    bool ce;
+    
+    uint8_t statusByte();
+    void updateFifoStatus();
+    void transmit();
+
+public:
+    NRF24_StubDevice();
+    
+    void reset();
+    uint8_t transfer(uint8_t cmd, const uint8_t *tx, uint8_t *rx, uint8_t len);
+    void setCE(bool high);
+    bool irqAsserted();
+};
+
+#endif
@@ -0,0 +1,649 @@
+#include "NRF24_Simulator.h"
+#include <string.h>
+
+// CRC-16-CCITT over the payload, standing in for the packet CRC in duplicate detection
+static uint16_t simCrc(const uint8_t *data, uint8_t len)
+{
+    uint16_t crc = 0xFFFF;
+    for (uint8_t i = 0; i < len; i++) {
+        crc ^= (uint16_t)data[i] << 8;
+        for (int bit = 0; bit < 8; bit++) {
+            crc = (crc & 0x8000) ? (crc << 1) ^ 0x1021 : crc << 1;
+        }
+    }
+    return crc;
+}
+
+static bool timeReached(uint32_t now, uint32_t when)
+{
+    return (int32_t)(now - when) >= 0;
+}
+
+static uint32_t laterOf(uint32_t a, uint32_t b)
+{
+    return timeReached(a, b) ? a : b;
+}
+
+// Air channel
+NRF24_SimAir::NRF24_SimAir()
+{
+    this->radio_count = 0;
+    this->clock_ns = 0;
+    this->now_us = 0;
+    this->advancing = false;
+    this->loss_percent = 0;
+    this->rng_state = 1;
+    memset(&stats, 0, sizeof(stats));
+}
+
+bool NRF24_SimAir::attach(NRF24_SimRadio *radio)
+{
+    if (radio_count >= NRF24_SIM_MAX_RADIOS) return false;
+    radios[radio_count++] = radio;
+    return true;
+}
+
+// Run every radio timer that falls due up to now_us, earliest first
+void NRF24_SimAir::advance(uint32_t now_us)
+{
+    if (advancing) return;
+    advancing = true;
+    
+    while (true) {
+        NRF24_SimRadio *next = NULL;
+        uint32_t next_us = 0;
+        for (uint8_t i = 0; i < radio_count; i++) {
+            uint32_t when;
+            if (radios[i]->hasEvent(&when) && timeReached(now_us, when) &&
+                (!next || (int32_t)(when - next_us) < 0)) {
+                next = radios[i];
+                next_us = when;
+            }
+        }
+        if (!next) break;
+        this->now_us = next_us;
+        next->runEvent();
+    }
+    
+    if (timeReached(now_us, this->now_us)) {
+        this->now_us = now_us;
+    }
+    advancing = false;
+}
+
+void NRF24_SimAir::setPacketLoss(uint8_t percent, uint32_t seed)
+{
+    loss_percent = percent > 100 ? 100 : percent;
+    rng_state = seed ? seed : 1;
+}
+
+bool NRF24_SimAir::lose()
+{
+    if (!loss_percent) return false;
+    
+    // xorshift32
+    rng_state ^= rng_state << 13;
+    rng_state ^= rng_state >> 17;
+    rng_state ^= rng_state << 5;
+    return (rng_state % 100) < loss_percent;
+}
+
+void NRF24_SimAir::getStats(NRF24_SimAirStats *stats)
+{
+    *stats = this->stats;
+}
+
+void NRF24_SimAir::resetStats()
+{
+    memset(&stats, 0, sizeof(stats));
+}
+
+bool NRF24_SimAir::deliver(NRF24_SimRadio *from, const NRF24_SimFrame *frame, uint8_t pid, NRF24_SimFrame *ack)
+{
+    stats.transmissions++;
+    ack->length = 0;
+    
+    bool acked = false;
+    for (uint8_t i = 0; i < radio_count; i++) {
+        NRF24_SimRadio *radio = radios[i];
+        if (radio == from || !radio->isListening(now_us) || radio->channel() != from->channel()) continue;
+        
+        // Any carrier on the channel trips RPD, decodable or not
+        radio->carrierDetected();
+        if (radio->rfSetup() != from->rfSetup() || radio->crcConfig() != from->crcConfig()) continue;
+        
+        uint8_t pipe;
+        if (!radio->matchAddress(from->txAddress(), from->txAddressWidth(), &pipe)) continue;
+        if (lose()) {
+            stats.lost++;
+            continue;
+        }
+        
+        bool radio_ack, duplicate, overflow;
+        NRF24_SimFrame payload;
+        if (!radio->receive(frame, pid, from->txDynamic(), pipe, &radio_ack, &payload, &duplicate, &overflow)) {
+            if (overflow) stats.rx_overflows++;
+            continue;
+        }
+        if (duplicate) {
+            stats.duplicates++;
+        } else {
+            stats.deliveries++;
+        }
+        
+        // Only the first ACK can be decoded; a second one would collide with it
+        if (radio_ack && !acked) {
+            if (lose()) {
+                stats.lost++;
+                continue;
+            }
+            stats.acks++;
+            acked = true;
+            *ack = payload;
+        }
+    }
+    return acked;
+}
+
+// Radio
+NRF24_SimRadio::NRF24_SimRadio(NRF24_SimAir *air)
+{
+    this->air = air;
+    reset();
+    air->attach(this);
+}
+
+// Datasheet reset values
+void NRF24_SimRadio::reset()
+{
+    memset(regs, 0, sizeof(regs));
+    regs[NRF_CONFIG_REGISTER] = 0x08;
+    regs[NRF_EN_AA_REGISTER] = 0x3F;
+    regs[NRF_EN_RXADDR_REGISTER] = 0x03;
+    regs[NRF_SETUP_AW_REGISTER] = 0x03;
+    regs[NRF_SETUP_RETR_REGISTER] = 0x03;
+    regs[NRF_RF_CH_REGISTER] = 0x02;
+    regs[NRF_RF_SETUP_REGISTER] = 0x0E;
+    regs[NRF_RX_ADDR_P2_REGISTER] = 0xC3;
+    regs[NRF_RX_ADDR_P3_REGISTER] = 0xC4;
+    regs[NRF_RX_ADDR_P4_REGISTER] = 0xC5;
+    regs[NRF_RX_ADDR_P5_REGISTER] = 0xC6;
+    memset(addr_p0, 0xE7, NRF_MAX_ADDR_SIZE);
+    memset(addr_p1, 0xC2, NRF_MAX_ADDR_SIZE);
+    memset(addr_tx, 0xE7, NRF_MAX_ADDR_SIZE);
+    regs[NRF_RX_ADDR_P0_REGISTER] = addr_p0[0];
+    regs[NRF_RX_ADDR_P1_REGISTER] = addr_p1[0];
+    regs[NRF_TX_ADDR_REGISTER] = addr_tx[0];
+    
+    tx_count = 0;
+    rx_count = 0;
+    tx_reuse = false;
+    ce = false;
+    ready_us = 0;
+    rx_ready_us = 0;
+    tx_event = TX_IDLE;
+    tx_event_us = 0;
+    tx_acked = false;
+    tx_head_sent = false;
+    tx_pid = 0;
+    tx_arc = 0;
+    tx_ack.length = 0;
+    for (int i = 0; i < NRF_MAX_PIPES; i++) {
+        last_valid[i] = false;
+        last_pid[i] = 0;
+        last_crc[i] = 0;
+    }
+}
+
+uint8_t NRF24_SimRadio::statusByte()
+{
+    uint8_t status = regs[NRF_STATUS_REGISTER] & (NRF_STATUS_RX_DR | NRF_STATUS_TX_DS | NRF_STATUS_MAX_RT);
+    status |= rx_count ? (rx_fifo[0].pipe << 1) : NRF_STATUS_RX_P_NO;
+    if (tx_count >= NRF24_SIM_FIFO_DEPTH) {
+        status |= NRF_STATUS_TX_FULL;
+    }
+    return status;
+}
+
+uint8_t NRF24_SimRadio::fifoStatus()
+{
+    uint8_t fifo = 0;
+    if (tx_reuse) fifo |= NRF_FIFO_STATUS_TX_REUSE;
+    if (tx_count >= NRF24_SIM_FIFO_DEPTH) fifo |= NRF_FIFO_STATUS_TX_FULL;
+    if (tx_count == 0) fifo |= NRF_FIFO_STATUS_TX_EMPTY;
+    if (rx_count >= NRF24_SIM_FIFO_DEPTH) fifo |= NRF_FIFO_STATUS_RX_FULL;
+    if (rx_count == 0) fifo |= NRF_FIFO_STATUS_RX_EMPTY;
+    return fifo;
+}
+
+bool NRF24_SimRadio::pipeDynamic(uint8_t pipe)
+{
+    return (regs[NRF_FEATURE_REGISTER] & NRF_FEATURE_EN_DPL) && (regs[NRF_DYNPD_REGISTER] & (1 << pipe));
+}
+
+uint8_t NRF24_SimRadio::addressWidth()
+{
+    uint8_t aw = regs[NRF_SETUP_AW_REGISTER] & 0x03;
+    return aw ? aw + 2 : NRF_MIN_ADDR_SIZE;
+}
+
+// Preamble, address, 9-bit packet control field, payload and CRC
+uint32_t NRF24_SimRadio::airtimeUs(uint8_t payload_len)
+{
+    uint8_t crc_bytes = 0;
+    if (regs[NRF_CONFIG_REGISTER] & NRF_CONFIG_EN_CRC) {
+        crc_bytes = (regs[NRF_CONFIG_REGISTER] & NRF_CONFIG_CRCO) ? 2 : 1;
+    }
+    uint32_t bits = 8 * (1 + addressWidth() + payload_len + crc_bytes) + 9;
+    
+    uint8_t rate = rfSetup();
+    if (rate & NRF_RF_SETUP_RF_DR_LOW) return bits * 4;       // 250 kbps
+    if (rate & NRF_RF_SETUP_RF_DR_HIGH) return (bits + 1) / 2; // 2 Mbps
+    return bits;                                              // 1 Mbps
+}
+
+uint32_t NRF24_SimRadio::retransmitDelayUs()
+{
+    return ((regs[NRF_SETUP_RETR_REGISTER] >> 4) + 1) * 250;
+}
+
+bool NRF24_SimRadio::matchAddress(const uint8_t *address, uint8_t width, uint8_t *pipe)
+{
+    if (width != addressWidth()) return false;
+    
+    for (uint8_t p = 0; p < NRF_MAX_PIPES; p++) {
+        if (!(regs[NRF_EN_RXADDR_REGISTER] & (1 << p))) continue;
+        
+        bool match;
+        if (p == 0) {
+            match = memcmp(address, addr_p0, width) == 0;
+        } else {
+            // Pipes 2-5 share bytes 1..n of pipe 1 and only own the LSB
+            uint8_t lsb = (p == 1) ? addr_p1[0] : regs[NRF_RX_ADDR_P0_REGISTER + p];
+            match = address[0] == lsb && memcmp(address + 1, addr_p1 + 1, width - 1) == 0;
+        }
+        if (match) {
+            *pipe = p;
+            return true;
+        }
+    }
+    return false;
+}
+
+// ACKs come back on pipe 0, so RX_ADDR_P0 must equal TX_ADDR
+bool NRF24_SimRadio::hearsAck()
+{
+    return memcmp(addr_p0, addr_tx, addressWidth()) == 0;
+}
+
+bool NRF24_SimRadio::isListening(uint32_t now)
+{
+    return poweredUp() && primRx() && ce && tx_event == TX_IDLE && timeReached(now, rx_ready_us);
+}
+
+bool NRF24_SimRadio::receive(const NRF24_SimFrame *frame, uint8_t pid, bool dynamic, uint8_t pipe,
+                             bool *ack, NRF24_SimFrame *ack_payload, bool *duplicate, bool *overflow)
+{
+    *ack = false;
+    *duplicate = false;
+    *overflow = false;
+    ack_payload->length = 0;
+    
+    // A packet control field or length mismatch fails the CRC check
+    if (dynamic != pipeDynamic(pipe)) return false;
+    if (!dynamic && (frame->length == 0 || frame->length != regs[NRF_RX_PW_P0_REGISTER + pipe])) return false;
+    
+    bool wants_ack = (regs[NRF_EN_AA_REGISTER] & (1 << pipe)) && !frame->no_ack;
+    uint16_t crc = simCrc(frame->data, frame->length);
+    if (wants_ack && last_valid[pipe] && last_pid[pipe] == pid && last_crc[pipe] == crc) {
+        // Retransmit of a packet whose ACK was lost: ACK again, do not store
+        *duplicate = true;
+    } else {
+        if (rx_count >= NRF24_SIM_FIFO_DEPTH) {
+            *overflow = true;
+            return false;
+        }
+        NRF24_SimFrame *slot = &rx_fifo[rx_count++];
+        *slot = *frame;
+        slot->pipe = pipe;
+        regs[NRF_STATUS_REGISTER] |= NRF_STATUS_RX_DR;
+        last_valid[pipe] = true;
+        last_pid[pipe] = pid;
+        last_crc[pipe] = crc;
+    }
+    
+    if (wants_ack) {
+        *ack = true;
+        uint8_t feature = regs[NRF_FEATURE_REGISTER];
+        if ((feature & NRF_FEATURE_EN_ACK_PAY) && (feature & NRF_FEATURE_EN_DPL)) {
+            int index = findAckPayload(pipe);
+            if (index >= 0) {
+                *ack_payload = tx_fifo[index];
+                popTx(index);
+                regs[NRF_STATUS_REGISTER] |= NRF_STATUS_TX_DS;
+            }
+        }
+    }
+    return true;
+}
+
+int NRF24_SimRadio::findAckPayload(uint8_t pipe)
+{
+    for (uint8_t i = 0; i < tx_count; i++) {
+        if (tx_fifo[i].pipe == pipe) return i;
+    }
+    return -1;
+}
+
+void NRF24_SimRadio::popTx(int index)
+{
+    for (int i = index; i + 1 < tx_count; i++) {
+        tx_fifo[i] = tx_fifo[i + 1];
+    }
+    tx_count--;
+    if (index == 0) {
+        tx_head_sent = false;
+    }
+}
+
+// Schedule the head packet if the PTX is allowed to send
+void NRF24_SimRadio::tryStartTx(uint32_t now)
+{
+    if (tx_event != TX_IDLE || !poweredUp() || primRx() || tx_count == 0) return;
+    if (regs[NRF_STATUS_REGISTER] & NRF_STATUS_MAX_RT) return; // Stalled until cleared
+    
+    tx_event = TX_START;
+    tx_event_us = laterOf(now, ready_us) + NRF24_SIM_SETTLE_US;
+    tx_arc = 0;
+    regs[NRF_OBSERVE_TX_REGISTER] &= 0xF0;
+}
+
+void NRF24_SimRadio::cancelTx()
+{
+    tx_event = TX_IDLE;
+}
+
+bool NRF24_SimRadio::hasEvent(uint32_t *when)
+{
+    if (tx_event == TX_IDLE) return false;
+    *when = tx_event_us;
+    return true;
+}
+
+void NRF24_SimRadio::runEvent()
+{
+    uint32_t now = tx_event_us;
+    
+    switch (tx_event) {
+        case TX_IDLE:
+            break;
+        
+        case TX_START:
+            if (tx_count == 0) { // Flushed while settling
+                tx_event = TX_IDLE;
+                break;
+            }
+            if (!tx_head_sent) {
+                tx_pid = (tx_pid + 1) & 0x03;
+                tx_head_sent = true;
+            }
+            tx_event = TX_AIR_END;
+            tx_event_us = now + airtimeUs(tx_fifo[0].length);
+            break;
+        
+        case TX_AIR_END: {
+            if (tx_count == 0) {
+                tx_event = TX_IDLE;
+                break;
+            }
+            bool expect_ack = (regs[NRF_EN_AA_REGISTER] & 0x01) && !tx_fifo[0].no_ack;
+            bool acked = air->deliver(this, &tx_fifo[0], tx_pid, &tx_ack);
+            if (!expect_ack) {
+                tx_acked = true;
+                tx_ack.length = 0;
+                tx_event = TX_COMPLETE;
+            } else if (acked && hearsAck()) {
+                tx_acked = true;
+                tx_event = TX_COMPLETE;
+                tx_event_us = now + NRF24_SIM_SETTLE_US + airtimeUs(tx_ack.length);
+            } else if (tx_arc < (regs[NRF_SETUP_RETR_REGISTER] & 0x0F)) {
+                tx_arc++;
+                tx_event = TX_START;
+                tx_event_us = now + retransmitDelayUs();
+            } else {
+                tx_acked = false;
+                tx_event = TX_COMPLETE;
+                tx_event_us = now + NRF24_SIM_SETTLE_US + airtimeUs(0);
+            }
+            break;
+        }
+        
+        case TX_COMPLETE: {
+            uint8_t observe = regs[NRF_OBSERVE_TX_REGISTER];
+            observe = (observe & 0xF0) | tx_arc;
+            if (tx_acked) {
+                regs[NRF_STATUS_REGISTER] |= NRF_STATUS_TX_DS;
+                if (tx_ack.length && rx_count < NRF24_SIM_FIFO_DEPTH) {
+                    NRF24_SimFrame *slot = &rx_fifo[rx_count++];
+                    *slot = tx_ack;
+                    slot->pipe = 0;
+                    regs[NRF_STATUS_REGISTER] |= NRF_STATUS_RX_DR;
+                }
+                if (!tx_reuse && tx_count) {
+                    popTx(0);
+                }
+            } else {
+                regs[NRF_STATUS_REGISTER] |= NRF_STATUS_MAX_RT;
+                if ((observe >> 4) < 0x0F) {
+                    observe += 0x10; // PLOS_CNT saturates at 15
+                }
+            }
+            regs[NRF_OBSERVE_TX_REGISTER] = observe;
+            tx_event = TX_IDLE;
+            
+            // CE still high: carry on with the next packet (standby-II when empty)
+            if (ce) {
+                tryStartTx(now);
+            }
+            break;
+        }
+    }
+}
+
+void NRF24_SimRadio::writeRegister(uint8_t reg, const uint8_t *data, uint8_t len)
+{
+    if (!len) return;
+    uint32_t now = air->now();
+    
+    switch (reg) {
+        case NRF_STATUS_REGISTER:
+            // Write 1 to clear
+            regs[reg] &= ~(data[0] & (NRF_STATUS_RX_DR | NRF_STATUS_TX_DS | NRF_STATUS_MAX_RT));
+            break;
+        
+        case NRF_CONFIG_REGISTER: {
+            uint8_t old = regs[reg];
+            regs[reg] = data[0];
+            if (!(old & NRF_CONFIG_PWR_UP) && (data[0] & NRF_CONFIG_PWR_UP)) {
+                ready_us = now + NRF24_SIM_POWER_UP_US;
+            }
+            if (!poweredUp() || primRx()) {
+                cancelTx();
+            }
+            if (ce && primRx() && !(old & NRF_CONFIG_PRIM_RX)) {
+                rx_ready_us = laterOf(now, ready_us) + NRF24_SIM_SETTLE_US;
+                regs[NRF_RPD_REGISTER] = 0;
+            }
+            break;
+        }
+        
+        case NRF_RF_CH_REGISTER:
+            regs[reg] = data[0] & 0x7F;
+            regs[NRF_OBSERVE_TX_REGISTER] &= 0x0F; // Resets PLOS_CNT
+            break;
+        
+        case NRF_RX_ADDR_P0_REGISTER:
+        case NRF_RX_ADDR_P1_REGISTER:
+        case NRF_TX_ADDR_REGISTER: {
+            uint8_t *target = (reg == NRF_RX_ADDR_P0_REGISTER) ? addr_p0 :
+                              (reg == NRF_RX_ADDR_P1_REGISTER) ? addr_p1 : addr_tx;
+            memcpy(target, data, len < NRF_MAX_ADDR_SIZE ? len : NRF_MAX_ADDR_SIZE);
+            regs[reg] = target[0];
+            break;
+        }
+        
+        case NRF_OBSERVE_TX_REGISTER:
+        case NRF_RPD_REGISTER:
+        case NRF_FIFO_STATUS_REGISTER:
+            break; // Read only
+        
+        default:
+            if (reg <= NRF_FEATURE_REGISTER) {
+                regs[reg] = data[0];
+            }
+            break;
+    }
+}
+
+void NRF24_SimRadio::readRegister(uint8_t reg, uint8_t *data, uint8_t len)
+{
+    memset(data, 0, len);
+    if (!len) return;
+    
+    switch (reg) {
+        case NRF_RX_ADDR_P0_REGISTER:
+            memcpy(data, addr_p0, len < NRF_MAX_ADDR_SIZE ? len : NRF_MAX_ADDR_SIZE);
+            break;
+        case NRF_RX_ADDR_P1_REGISTER:
+            memcpy(data, addr_p1, len < NRF_MAX_ADDR_SIZE ? len : NRF_MAX_ADDR_SIZE);
+            break;
+        case NRF_TX_ADDR_REGISTER:
+            memcpy(data, addr_tx, len < NRF_MAX_ADDR_SIZE ? len : NRF_MAX_ADDR_SIZE);
+            break;
+        case NRF_STATUS_REGISTER:
+            data[0] = statusByte();
+            break;
+        case NRF_FIFO_STATUS_REGISTER:
+            data[0] = fifoStatus();
+            break;
+        default:
+            if (reg <= NRF_FEATURE_REGISTER) {
+                data[0] = regs[reg];
+            }
+            break;
+    }
+}
+
+// Command decoder. STATUS is shifted out before the command takes effect.
+uint8_t NRF24_SimRadio::transfer(uint8_t cmd, const uint8_t *tx, uint8_t *rx, uint8_t len)
+{
+    uint8_t status = statusByte();
+    
+    if (cmd <= 0x1F) {
+        if (rx) readRegister(cmd & 0x1F, rx, len);
+        return status;
+    }
+    if (cmd <= 0x3F) {
+        if (tx) writeRegister(cmd & 0x1F, tx, len);
+        return status;
+    }
+    if ((cmd & 0xF8) == NRF_W_ACK_PAYLOAD && (cmd & 0x07) < NRF_MAX_PIPES) {
+        if (tx && tx_count < NRF24_SIM_FIFO_DEPTH) {
+            NRF24_SimFrame *slot = &tx_fifo[tx_count++];
+            slot->pipe = cmd & 0x07;
+            slot->length = len > NRF_MAX_PAYLOAD_SIZE ? NRF_MAX_PAYLOAD_SIZE : len;
+            slot->no_ack = false;
+            memcpy(slot->data, tx, slot->length);
+        }
+        return status;
+    }
+    
+    switch (cmd) {
+        case NRF_R_RX_PAYLOAD:
+            if (rx) {
+                memset(rx, 0, len);
+                if (rx_count) {
+                    memcpy(rx, rx_fifo[0].data, len < rx_fifo[0].length ? len : rx_fifo[0].length);
+                    for (uint8_t i = 1; i < rx_count; i++) {
+                        rx_fifo[i - 1] = rx_fifo[i];
+                    }
+                    rx_count--;
+                }
+            }
+            break;
+        
+        case NRF_R_RX_PL_WID:
+            if (rx && len) {
+                memset(rx, 0, len);
+                rx[0] = rx_count ? rx_fifo[0].length : 0;
+            }
+            break;
+        
+        case NRF_W_TX_PAYLOAD:
+        case NRF_W_TX_PAYLOAD_NO_ACK:
+            if (tx && tx_count < NRF24_SIM_FIFO_DEPTH) {
+                NRF24_SimFrame *slot = &tx_fifo[tx_count++];
+                slot->pipe = 0xFF;
+                slot->length = len > NRF_MAX_PAYLOAD_SIZE ? NRF_MAX_PAYLOAD_SIZE : len;
+                slot->no_ack = (cmd == NRF_W_TX_PAYLOAD_NO_ACK) &&
+                               (regs[NRF_FEATURE_REGISTER] & NRF_FEATURE_EN_DYN_ACK);
+                memcpy(slot->data, tx, slot->length);
+                tx_reuse = false;
+                
+                // Standby-II: a new payload goes straight out
+                if (ce) {
+                    tryStartTx(air->now());
+                }
+            }
+            break;
+        
+        case NRF_FLUSH_TX:
+            tx_count = 0;
+            tx_reuse = false;
+            tx_head_sent = false;
+            break;
+        
+        case NRF_FLUSH_RX:
+            rx_count = 0;
+            break;
+        
+        case NRF_REUSE_TX_PL:
+            tx_reuse = true;
+            break;
+        
+        default:
+            // NOP, ACTIVATE and unknown opcodes
+            if (rx) {
+                memset(rx, 0, len);
+            }
+            break;
+    }
+    return status;
+}
+
+void NRF24_SimRadio::setCE(bool high)
+{
+    bool rising = high && !ce;
+    ce = high;
+    if (!rising) return;
+    
+    uint32_t now = air->now();
+    if (primRx()) {
+        rx_ready_us = laterOf(now, ready_us) + NRF24_SIM_SETTLE_US;
+        regs[NRF_RPD_REGISTER] = 0;
+    } else {
+        tryStartTx(now);
+    }
+}
+
+void NRF24_SimRadio::advance(uint32_t now_us)
+{
+    air->advance(now_us);
+}
+
+bool NRF24_SimRadio::irqAsserted()
+{
+    uint8_t flags = regs[NRF_STATUS_REGISTER] & (NRF_STATUS_RX_DR | NRF_STATUS_TX_DS | NRF_STATUS_MAX_RT);
+    uint8_t masked = regs[NRF_CONFIG_REGISTER] & (NRF_CONFIG_MASK_RX_DR | NRF_CONFIG_MASK_TX_DS | NRF_CONFIG_MASK_MAX_RT);
+    return (flags & ~masked) != 0;
+}
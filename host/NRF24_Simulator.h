@@ -0,0 +1,156 @@
+
+#ifndef __NRF24_SIMULATOR_H_
+#define __NRF24_SIMULATOR_H_
+
+#include "NRF24_HostTransport.h"
+
+// Simulation limits and chip timing
+#define NRF24_SIM_MAX_RADIOS        8
+#define NRF24_SIM_FIFO_DEPTH        3
+#define NRF24_SIM_POWER_UP_US       1500  // Tpd2stby
+#define NRF24_SIM_SETTLE_US         130   // Tstby2a, also the TX/RX turnaround for ACKs
+
+// One frame in a TX or RX FIFO
+typedef struct {
+    uint8_t pipe;      // RX: receiving pipe. TX: ACK payload pipe, or 0xFF for a data packet
+    uint8_t length;
+    bool no_ack;
+    uint8_t data[NRF_MAX_PAYLOAD_SIZE];
+} NRF24_SimFrame;
+
+// Traffic seen on the virtual air since the last reset
+typedef struct {
+    uint32_t transmissions;  // Every attempt put on air, retransmits included
+    uint32_t deliveries;     // New packets stored in a receiver's RX FIFO
+    uint32_t duplicates;     // Retransmits recognized by PID and discarded
+    uint32_t acks;
+    uint32_t lost;           // Frames or ACKs dropped by the loss model
+    uint32_t rx_overflows;   // Packets discarded because the RX FIFO was full
+} NRF24_SimAirStats;
+
+class NRF24_SimRadio;
+
+// Virtual air channel linking simulated radios. Owns the clock that every radio's
+// NRF24_HostTransport must share, and runs all radio timers in time order.
+class NRF24_SimAir
+{
+private:
+    NRF24_SimRadio *radios[NRF24_SIM_MAX_RADIOS];
+    uint8_t radio_count;
+    uint64_t clock_ns;
+    uint32_t now_us;
+    bool advancing;
+    
+    // Loss model
+    uint8_t loss_percent;
+    uint32_t rng_state;
+    NRF24_SimAirStats stats;
+    
+    bool lose();
+
+public:
+    NRF24_SimAir();
+    
+    uint64_t *clock() { return &clock_ns; }
+    uint32_t now() { return now_us; }
+    bool attach(NRF24_SimRadio *radio);
+    void advance(uint32_t now_us);
+    
+    // Drop this percentage of frames and ACKs, from a repeatable sequence
+    void setPacketLoss(uint8_t percent, uint32_t seed = 1);
+    void getStats(NRF24_SimAirStats *stats);
+    void resetStats();
+    
+    // Called by a transmitting radio when its frame leaves the air. Returns true if a
+    // receiver acknowledged it; ack then holds the ACK payload (length 0 if none).
+    bool deliver(NRF24_SimRadio *from, const NRF24_SimFrame *frame, uint8_t pid, NRF24_SimFrame *ack);
+};
+
+// Register-level model of one nRF24L01+: register file, command decoder, 3-deep TX
+// and RX FIFOs, STATUS/IRQ semantics and Enhanced ShockBurst auto-ack/retransmit
+// timing. Attach it to an NRF24_SimAir and drive it through an NRF24_HostTransport.
+class NRF24_SimRadio : public NRF24_HostDevice
+{
+private:
+    enum TxEvent {
+        TX_IDLE = 0,
+        TX_START,      // Settled: the head packet goes on air
+        TX_AIR_END,    // Last bit sent: receivers decide
+        TX_COMPLETE    // ACK received or ACK wait expired
+    };
+    
+    NRF24_SimAir *air;
+    uint8_t regs[NRF_FEATURE_REGISTER + 1];
+    uint8_t addr_p0[NRF_MAX_ADDR_SIZE];
+    uint8_t addr_p1[NRF_MAX_ADDR_SIZE];
+    uint8_t addr_tx[NRF_MAX_ADDR_SIZE];
+    
+    NRF24_SimFrame tx_fifo[NRF24_SIM_FIFO_DEPTH];
+    uint8_t tx_count;
+    NRF24_SimFrame rx_fifo[NRF24_SIM_FIFO_DEPTH];
+    uint8_t rx_count;
+    bool tx_reuse;
+    
+    bool ce;
+    uint32_t ready_us;       // Standby reachable (PWR_UP + Tpd2stby)
+    uint32_t rx_ready_us;    // Listening (CE high in PRX + Tstby2a)
+    
+    // Transmitter
+    TxEvent tx_event;
+    uint32_t tx_event_us;
+    bool tx_acked;
+    bool tx_head_sent;       // The head packet already has its PID
+    uint8_t tx_pid;
+    uint8_t tx_arc;
+    NRF24_SimFrame tx_ack;
+    
+    // Receiver duplicate detection
+    uint8_t last_pid[NRF_MAX_PIPES];
+    uint16_t last_crc[NRF_MAX_PIPES];
+    bool last_valid[NRF_MAX_PIPES];
+    
+    uint8_t statusByte();
+    uint8_t fifoStatus();
+    bool poweredUp() { return regs[NRF_CONFIG_REGISTER] & NRF_CONFIG_PWR_UP; }
+    bool primRx() { return regs[NRF_CONFIG_REGISTER] & NRF_CONFIG_PRIM_RX; }
+    bool pipeDynamic(uint8_t pipe);
+    uint8_t addressWidth();
+    uint32_t airtimeUs(uint8_t payload_len);
+    uint32_t retransmitDelayUs();
+    void writeRegister(uint8_t reg, const uint8_t *data, uint8_t len);
+    void readRegister(uint8_t reg, uint8_t *data, uint8_t len);
+    bool hearsAck();
+    void tryStartTx(uint32_t now);
+    void cancelTx();
+    int findAckPayload(uint8_t pipe);
+    void popTx(int index);
+
+public:
+    NRF24_SimRadio(NRF24_SimAir *air);
+    
+    // Power-on reset
+    void reset();
+    
+    // NRF24_HostDevice
+    uint8_t transfer(uint8_t cmd, const uint8_t *tx, uint8_t *rx, uint8_t len);
+    void setCE(bool high);
+    void advance(uint32_t now_us);
+    bool irqAsserted();
+    
+    // Used by NRF24_SimAir
+    bool hasEvent(uint32_t *when);
+    void runEvent();
+    bool isListening(uint32_t now);
+    uint8_t channel() { return regs[NRF_RF_CH_REGISTER] & 0x7F; }
+    uint8_t rfSetup() { return regs[NRF_RF_SETUP_REGISTER] & (NRF_RF_SETUP_RF_DR_LOW | NRF_RF_SETUP_RF_DR_HIGH); }
+    uint8_t crcConfig() { return regs[NRF_CONFIG_REGISTER] & (NRF_CONFIG_EN_CRC | NRF_CONFIG_CRCO); }
+    bool matchAddress(const uint8_t *address, uint8_t width, uint8_t *pipe);
+    bool txDynamic() { return pipeDynamic(0); }
+    const uint8_t *txAddress() { return addr_tx; }
+    uint8_t txAddressWidth() { return addressWidth(); }
+    bool receive(const NRF24_SimFrame *frame, uint8_t pid, bool dynamic, uint8_t pipe,
+                 bool *ack, NRF24_SimFrame *ack_payload, bool *duplicate, bool *overflow);
+    void carrierDetected() { regs[NRF_RPD_REGISTER] = 0x01; }
+};
+
+#endif